@@ -0,0 +1,336 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_BATCHREPORT_H
+#define PROJ1_BATCHREPORT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <fstream>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cmath>
+#include <glob.h>
+#include <sys/stat.h>
+#include "statistics.h"
+#include "workStealingPool.h"
+#include "reportWriter.h"
+#include "ui/RenderArena.h"
+#include "ui/TypedTable.h"
+#include "ui/RenderBuffer.h"
+#include "ui/OutputSink.h"
+#include "ui/UIExcept.h"
+
+/** Bytes that the files being analyzed may use together. A file waits until its estimate
+ *  fits in what is left, except when nothing else is loaded, so a file larger than the
+ *  whole budget still runs, alone.
+ */
+class MemoryBudget
+{
+public:
+    /// Released when it is destroyed
+    class Reservation
+    {
+    public:
+        Reservation(MemoryBudget& _budget, std::size_t _bytes) : budget {_budget}, bytes {_bytes} {}
+        Reservation(const Reservation&) = delete;
+        Reservation& operator=(const Reservation&) = delete;
+        ~Reservation() { budget.release(bytes); }
+
+    private:
+        MemoryBudget& budget;
+        std::size_t bytes;
+    };
+
+    explicit MemoryBudget(std::size_t _limit) : limit {_limit} {}
+
+    /// Wait until bytes fit in the budget
+    Reservation reserve(std::size_t bytes)
+    {
+        auto lock = std::unique_lock<std::mutex>(mutex);
+        released.wait(lock, [this, bytes] { return used == 0 || used + bytes <= limit; });
+        used += bytes;
+        return Reservation(*this, bytes);
+    }
+
+private:
+    std::size_t limit;
+    std::size_t used = 0;
+    std::mutex mutex;
+    std::condition_variable released;
+
+    void release(std::size_t bytes)
+    {
+        {
+            auto lock = std::lock_guard<std::mutex>(mutex);
+            used -= bytes;
+        }
+        released.notify_all();
+    }
+};
+
+/// One row of the batch summary. Statistics are empty when the file could not be analyzed.
+struct FileSummary
+{
+    std::string path;
+    std::optional<std::string> error;
+    std::optional<std::size_t> count;
+    std::optional<long> minimum, maximum, sum;
+    std::optional<double> mean, median, standardDeviation, q1, q3;
+};
+
+namespace batch_report_detail
+{
+    /// Memory taken by the values of a file, per byte of the file, for values of about seven digits:
+    /// 8 bytes per value for the sorted values and up to 16 more while the values vector grows,
+    /// for 8 bytes of text. No range tree is built for a summary.
+    constexpr std::size_t BYTES_PER_FILE_BYTE = 3;
+
+    inline std::size_t estimateMemory(const std::string& path)
+    {
+        struct stat status {};
+        if (::stat(path.c_str(), &status) != 0)
+            return 0;
+        return static_cast<std::size_t>(status.st_size) * BYTES_PER_FILE_BYTE;
+    }
+
+    inline FileSummary summarize(const std::string& path)
+    {
+        auto summary = FileSummary {};
+        summary.path = path;
+        try
+        {
+            auto statistics = Statistics<long>();
+            statistics.loadDataFromFilePath(path);
+            if (statistics.getSize() == 0)
+                throw UIExcept("No elements in array");
+            const auto& quartiles = statistics.getQuartiles();
+            summary.count = statistics.getSize();
+            summary.minimum = statistics.getMin();
+            summary.maximum = statistics.getMax();
+            summary.sum = statistics.getSum();
+            summary.mean = statistics.getMean();
+            summary.median = statistics.getMedian();
+            summary.standardDeviation = statistics.getStandardDeviation();
+            summary.q1 = quartiles.Q1;
+            summary.q3 = quartiles.Q3;
+        }
+        catch (UIExcept& e)
+        {
+            summary.error = e.what();
+        }
+        catch (std::bad_alloc&)
+        {
+            summary.error = "Out of memory";
+        }
+        catch (std::exception& e)
+        {
+            summary.error = e.what();
+        }
+        return summary;
+    }
+
+    /// Text as a JSON string, in quotes
+    inline void appendJsonString(RenderBuffer& buffer, std::string_view text)
+    {
+        buffer.append('"');
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                buffer.append('\\');
+                buffer.append(c);
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                const char* hex = "0123456789abcdef";
+                buffer.append("\\u00");
+                buffer.append(hex[(c >> 4) & 0xF]);
+                buffer.append(hex[c & 0xF]);
+            }
+            else
+                buffer.append(c);
+        }
+        buffer.append('"');
+    }
+
+    /// Text as a CSV field, quoted when it contains a separator, a quote or a line break
+    inline void appendCsvField(RenderBuffer& buffer, std::string_view text)
+    {
+        if (text.find_first_of(",\"\r\n") == std::string_view::npos)
+        {
+            buffer.append(text);
+            return;
+        }
+        buffer.append('"');
+        for (char c : text)
+        {
+            if (c == '"')
+                buffer.append('"');
+            buffer.append(c);
+        }
+        buffer.append('"');
+    }
+
+    /// missing is written for an empty value and for one that is not finite
+    template <typename T>
+    void appendNumber(RenderBuffer& buffer, const std::optional<T>& value, std::string_view missing)
+    {
+        if (!value.has_value())
+            buffer.append(missing);
+        else if constexpr (std::is_floating_point<T>::value)
+        {
+            if (std::isfinite(*value))
+                buffer.append(FormattedNumber::shortest(*value));
+            else
+                buffer.append(missing);
+        }
+        else
+            buffer.append(FormattedNumber::integer(static_cast<long long>(*value)));
+    }
+}
+
+/** Files named by the arguments: glob patterns are expanded, @list reads one path per line
+ *  from list, and anything else is taken as a path.
+ */
+inline std::vector<std::string> expandFileArguments(const std::vector<std::string>& arguments)
+{
+    std::vector<std::string> paths;
+    for (const auto& argument : arguments)
+    {
+        if (!argument.empty() && argument.front() == '@')
+        {
+            auto list = std::ifstream(argument.substr(1));
+            if (!list.is_open())
+                throw UIExcept("Cannot open file list " + argument.substr(1));
+            for (std::string line; std::getline(list, line);)
+                if (!line.empty())
+                    paths.push_back(line);
+        }
+        else if (argument.find_first_of("*?[") != std::string::npos)
+        {
+            glob_t matches {};
+            if (::glob(argument.c_str(), 0, nullptr, &matches) == 0)
+                for (std::size_t i = 0; i < matches.gl_pathc; i++)
+                    paths.emplace_back(matches.gl_pathv[i]);
+            ::globfree(&matches);
+        }
+        else
+            paths.push_back(argument);
+    }
+    return paths;
+}
+
+/** Load and analyze every file on a WorkStealingPool, at most memoryLimit bytes of values
+ *  at a time. Summaries are in the order of the paths, whatever order they finish in.
+ */
+inline std::vector<FileSummary> summarizeFiles(const std::vector<std::string>& paths,
+                                               std::size_t threadCount,
+                                               std::size_t memoryLimit)
+{
+    using namespace batch_report_detail;
+    std::vector<FileSummary> summaries(paths.size());
+    auto budget = MemoryBudget(memoryLimit);
+    {
+        auto pool = WorkStealingPool(std::min(threadCount, std::max<std::size_t>(1, paths.size())));
+        for (std::size_t i = 0; i < paths.size(); i++)
+            pool.submit([&summaries, &budget, &paths, i]
+            {
+                auto reservation = budget.reserve(estimateMemory(paths[i]));
+                summaries[i] = summarize(paths[i]);
+            });
+    }
+    return summaries;
+}
+
+/** One row per file: a table, CSV with a header line or JSON lines. Missing statistics are
+ *  None in the table, empty in CSV and null in JSON. Binary is not supported.
+ */
+inline void writeBatchSummary(ReportFormat format, const std::vector<FileSummary>& summaries, OutputSink& sink)
+{
+    using namespace batch_report_detail;
+    if (format == ReportFormat::Table)
+    {
+        using SummaryTable = TypedTable<Col<std::string>, Col<std::optional<std::size_t>>,
+                                        Col<std::optional<long>>, Col<std::optional<long>>, Col<std::optional<long>>,
+                                        Col<std::optional<double>>, Col<std::optional<double>>, Col<std::optional<double>>,
+                                        Col<std::optional<double>>, Col<std::optional<double>>, Col<std::string>>;
+        auto arena = RenderArena();
+        auto table = arena.create<SummaryTable>(
+            SummaryTable::Columns {{L"File"}, {L"Size"}, {L"Minimum"}, {L"Maximum"}, {L"Sum"}, {L"Mean"},
+                                   {L"Median"}, {L"Std Dev"}, {L"Q1"}, {L"Q3"}, {L"Status"}},
+            L"Summary of " + std::to_wstring(summaries.size()) + L" files");
+        for (const auto& s : summaries)
+            table->addRow(s.path, s.count, s.minimum, s.maximum, s.sum, s.mean, s.median, s.standardDeviation,
+                          s.q1, s.q3, s.error.value_or("ok"));
+        table->dumpTableTo(sink);
+        return;
+    }
+    if (format != ReportFormat::Csv && format != ReportFormat::JsonLines)
+        throw UIExcept("Batch summaries are written as a table, CSV or JSON lines");
+
+    auto buffer = RenderBuffer(sink);
+    if (format == ReportFormat::Csv)
+    {
+        buffer.append("file,count,minimum,maximum,sum,mean,median,standard_deviation,q1,q3,error\n");
+        for (const auto& s : summaries)
+        {
+            auto number = [&buffer](const auto& value)
+            {
+                buffer.append(',');
+                appendNumber(buffer, value, "");
+            };
+            appendCsvField(buffer, s.path);
+            number(s.count);
+            number(s.minimum);
+            number(s.maximum);
+            number(s.sum);
+            number(s.mean);
+            number(s.median);
+            number(s.standardDeviation);
+            number(s.q1);
+            number(s.q3);
+            buffer.append(',');
+            appendCsvField(buffer, s.error.value_or(""));
+            buffer.append('\n');
+        }
+    }
+    else
+    {
+        for (const auto& s : summaries)
+        {
+            auto number = [&buffer](std::string_view name, const auto& value)
+            {
+                buffer.append(",\"");
+                buffer.append(name);
+                buffer.append("\":");
+                appendNumber(buffer, value, "null");
+            };
+            buffer.append("{\"file\":");
+            appendJsonString(buffer, s.path);
+            number("count", s.count);
+            number("minimum", s.minimum);
+            number("maximum", s.maximum);
+            number("sum", s.sum);
+            number("mean", s.mean);
+            number("median", s.median);
+            number("standard_deviation", s.standardDeviation);
+            number("q1", s.q1);
+            number("q3", s.q3);
+            buffer.append(",\"error\":");
+            if (s.error.has_value())
+                appendJsonString(buffer, s.error.value());
+            else
+                buffer.append("null");
+            buffer.append("}\n");
+        }
+    }
+    buffer.flush();
+    sink.flush();
+}
+
+#endif //PROJ1_BATCHREPORT_H
@@ -0,0 +1,177 @@
+//
+// Created by dop on 10/19/26.
+//
+// Renders the same views as virtual Tables of columns and as TypedTables, and prints the
+// best time of a few runs of each. Not built by default:
+//     cmake --build <build dir> --target typedTableBenchmark
+//
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "statisticsReport.h"
+#include "ui/Table.h"
+#include "ui/MixedColumn.h"
+#include "ui/StreamingColumn.h"
+#include "ui/TypedTable.h"
+#include "ui/RenderArena.h"
+#include "ui/OutputSink.h"
+
+namespace
+{
+    using FrequencyEntry = Statistics<long>::FrequencyEntry;
+    using FrequencyTable = StatisticsReport::FrequencyTable;
+    using MenuTable = TypedTable<Col<const wchar_t*>, Col<const wchar_t*>>;
+
+    /// Drops the rendered text, so only the rendering is timed
+    class NullSink : public OutputSink
+    {
+    public:
+        void write(std::string_view text) override
+        {
+            bytes += text.size();
+        }
+
+        std::size_t bytes = 0;
+    };
+
+    /// Best of runs timings of work, in milliseconds
+    template <typename Work>
+    double bestOf(int runs, Work work)
+    {
+        using Clock = std::chrono::steady_clock;
+        double best = 0;
+        for (int run = 0; run < runs; run++)
+        {
+            auto start = Clock::now();
+            work();
+            double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (run == 0 || elapsed < best)
+                best = elapsed;
+        }
+        return best;
+    }
+
+    void printTimes(const char* view, double virtualMs, double typedMs)
+    {
+        std::printf("%-38s %8.1f ms -> %8.1f ms\n", view, virtualMs, typedMs);
+    }
+
+    const wchar_t* const MENU[][2] = {
+        {L"A> Load data file",                      L"M> Mid Range"},
+        {L"B> Minimum",                             L"N> Quartiles"},
+        {L"C> Maximum",                             L"O> Interquartile Range"},
+        {L"D> Range",                               L"P> Outliers"},
+        {L"E> Size",                                L"Q> Sum of Squares"},
+        {L"F> Sum",                                 L"R> Mean Absolute Deviation"},
+        {L"G> Mean",                                L"S> Root Mean Square"},
+        {L"H> Median",                              L"T> Standard Error of the Mean"},
+        {L"I> Frequencies",                         L"U> Coefficient of Variation"},
+        {L"J> Mode",                                L"V> Relative Standard Deviation"},
+        {L"K> Standard Deviation",                  L"X> Rolling Statistics"},
+        {L"L> Variance",                            L"Y> Range Statistics"},
+        {L"W> Display result and write to file.",   L"Z> Histogram"},
+        {L"0> Return",                              L"1> Bootstrap Confidence Intervals"},
+        {L"",                                       L"2> Load sample of data file"},
+        {L"",                                       L"3> Refine sample"},
+        {L"",                                       L"4> Enter values"},
+    };
+}
+
+int main()
+{
+    constexpr int RUNS = 7;
+    constexpr std::size_t ROWS = 1000000;
+    constexpr int MENU_RENDERS = 100000;
+
+    std::vector<FrequencyEntry> entries(ROWS);
+    for (std::size_t i = 0; i < ROWS; i++)
+    {
+        long frequency = long(i % 97 + 1);
+        entries[i] = FrequencyEntry {long(i * 7) - 300000, frequency, frequency / 5e7};
+    }
+    NullSink sink;
+
+    std::printf("Best of %d runs, rendered to a null sink, virtual -> typed:\n", RUNS);
+
+    // frequency table: three streaming columns over one cursor, or one stream of typed rows
+    double streamedVirtual = bestOf(RUNS, [&]()
+    {
+        auto arena = RenderArena();
+        auto stream = arena.create<VectorRowStream<FrequencyEntry>>(std::vector<FrequencyEntry>(entries));
+        auto rows = arena.create<SharedRowCursor<FrequencyEntry>>(*stream);
+        auto values = arena.create<StreamingColumn<FrequencyEntry, long>>(
+            *rows, [](const FrequencyEntry& entry) { return entry.value; }, 0, 5, L"Values");
+        auto frequencies = arena.create<StreamingColumn<FrequencyEntry, long>>(
+            *rows, [](const FrequencyEntry& entry) { return entry.frequency; }, 0, 5, L"Frequency");
+        auto percentages = arena.create<StreamingColumn<FrequencyEntry, double>>(
+            *rows, [](const FrequencyEntry& entry) { return 100 * entry.frequencyPercentage; }, 0, 5, L"Percentage");
+        arena.create<Table>(Table::ColumnList {values, frequencies, percentages}, L"", -1, false)->dumpTableTo(sink);
+    });
+    double streamedTyped = bestOf(RUNS, [&]()
+    {
+        auto arena = RenderArena();
+        auto stream = arena.create<VectorRowStream<FrequencyEntry>>(std::vector<FrequencyEntry>(entries));
+        StatisticsReport::frequencyTableToUITable(arena, *stream)->dumpTableTo(sink);
+    });
+    printTimes("frequency table, 1e6 streamed rows", streamedVirtual, streamedTyped);
+
+    // the same rows stored in the table
+    double storedVirtual = bestOf(RUNS, [&]()
+    {
+        auto arena = RenderArena();
+        auto values = arena.create<MixedColumn>(0, 5, L"Values");
+        auto frequencies = arena.create<MixedColumn>(0, 5, L"Frequency");
+        auto percentages = arena.create<MixedColumn>(0, 5, L"Percentage");
+        for (const auto& entry : entries)
+        {
+            values->addItems(entry.value);
+            frequencies->addItems(entry.frequency);
+            percentages->addItems(100 * entry.frequencyPercentage);
+        }
+        arena.create<Table>(Table::ColumnList {values, frequencies, percentages}, L"", -1, false)->dumpTableTo(sink);
+    });
+    double storedTyped = bestOf(RUNS, [&]()
+    {
+        auto arena = RenderArena();
+        auto table = arena.create<FrequencyTable>(
+            FrequencyTable::Columns {{L"Values"}, {L"Frequency"}, {L"Percentage"}}, L"", -1, false);
+        for (const auto& entry : entries)
+            table->addRow(entry.value, entry.frequency, 100 * entry.frequencyPercentage);
+        table->dumpTableTo(sink);
+    });
+    printTimes("3 numeric columns, 1e6 stored rows", storedVirtual, storedTyped);
+
+    // the menu of StatsUI, which is rendered before every option
+    double menuVirtual = bestOf(RUNS, [&]()
+    {
+        for (int render = 0; render < MENU_RENDERS; render++)
+        {
+            auto arena = RenderArena();
+            auto left = arena.create<MixedColumn>(0, 5, L"");
+            auto right = arena.create<MixedColumn>(0, 5, L"");
+            for (const auto& row : MENU)
+            {
+                left->addItems(row[0]);
+                right->addItems(row[1]);
+            }
+            arena.create<Table>(Table::ColumnList {left, right}, L"3> Descriptive Statistics")->dumpTableTo(sink);
+        }
+    });
+    double menuTyped = bestOf(RUNS, [&]()
+    {
+        for (int render = 0; render < MENU_RENDERS; render++)
+        {
+            auto arena = RenderArena();
+            auto menu = arena.create<MenuTable>(MenuTable::Columns {}, L"3> Descriptive Statistics");
+            for (const auto& row : MENU)
+                menu->addRow(row[0], row[1]);
+            menu->dumpTableTo(sink);
+        }
+    });
+    printTimes("menu, 1e5 renders", menuVirtual, menuTyped);
+
+    // keeps the rendering from being optimized away
+    std::printf("%zu bytes rendered\n", sink.bytes);
+    return 0;
+}
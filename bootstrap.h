@@ -0,0 +1,250 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_BOOTSTRAP_H
+#define PROJ1_BOOTSTRAP_H
+
+#include <vector>
+#include <thread>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "counterRng.h"
+#include "ui/UIExcept.h"
+
+struct ConfidenceInterval
+{
+    double estimate;
+    double lower;
+    double upper;
+};
+
+struct BootstrapResult
+{
+    ConfidenceInterval mean;
+    ConfidenceInterval median;
+    ConfidenceInterval standardDeviation;
+    std::size_t resampleCount;
+    double confidenceLevel;
+};
+
+namespace bootstrap_detail
+{
+    // Resamples are drawn block by block so every random access stays inside
+    // a block of sorted values that fits in L1.
+    constexpr std::size_t BLOCK_SIZE = 4096;
+
+    struct ResampleStatistics
+    {
+        double mean;
+        double median;
+        double standardDeviation;
+    };
+
+    /** Per-thread scratch space, allocated once and reused by every resample. */
+    template <typename T>
+    class Resampler
+    {
+    public:
+        Resampler(const std::vector<T>& _sortedValues, double _shift)
+            :
+            sortedValues {_sortedValues},
+            shift {_shift},
+            blockCount {(_sortedValues.size() + BLOCK_SIZE - 1) / BLOCK_SIZE},
+            drawsPerBlock (blockCount),
+            countsInBlock (BLOCK_SIZE)
+        {}
+
+        /** One resample of n draws with replacement. The number of draws that land in each
+         *  block is multinomial, generated as a chain of conditional binomials. The draws are
+         *  then made inside each block. The median positions are found from the per-block
+         *  draw counts, because the values are sorted.
+         */
+        ResampleStatistics resample(CounterRng& rng)
+        {
+            const std::size_t n = sortedValues.size();
+            std::size_t remainingDraws = n;
+            std::size_t remainingValues = n;
+            for (std::size_t block = 0; block < blockCount; block++)
+            {
+                std::size_t blockSize = getBlockSize(block);
+                if (remainingDraws == 0 || blockSize == remainingValues)
+                    drawsPerBlock[block] = remainingDraws;
+                else
+                    drawsPerBlock[block] = std::binomial_distribution<std::size_t>(
+                        remainingDraws, static_cast<double>(blockSize) / remainingValues)(rng);
+                remainingDraws -= drawsPerBlock[block];
+                remainingValues -= blockSize;
+            }
+
+            // 0-based positions of the median(s) in the sorted resample
+            std::size_t lowMedianPosition = (n - 1) / 2;
+            std::size_t highMedianPosition = n / 2;
+            double lowMedian = 0.0, highMedian = 0.0;
+
+            double sum = 0.0, sumOfSquares = 0.0;
+            std::size_t drawsBefore = 0;
+            for (std::size_t block = 0; block < blockCount; block++)
+            {
+                std::size_t draws = drawsPerBlock[block];
+                std::size_t blockSize = getBlockSize(block);
+                const T* blockValues = sortedValues.data() + block * BLOCK_SIZE;
+                bool holdsMedian = drawsBefore + draws > lowMedianPosition && drawsBefore <= highMedianPosition;
+
+                if (holdsMedian)
+                {
+                    std::fill(countsInBlock.begin(), countsInBlock.begin() + blockSize, 0);
+                    for (std::size_t d = 0; d < draws; d++)
+                        countsInBlock[((rng() >> 32) * blockSize) >> 32]++;
+                    for (std::size_t index = 0; index < blockSize; index++)
+                    {
+                        double centered = blockValues[index] - shift;
+                        sum += countsInBlock[index] * centered;
+                        sumOfSquares += countsInBlock[index] * centered * centered;
+                    }
+                }
+                else
+                {
+                    // Two independent accumulator pairs and two 32-bit draws per random number
+                    // keep the loop throughput bound instead of latency bound.
+                    double sumEven = 0.0, sumOdd = 0.0, squaresEven = 0.0, squaresOdd = 0.0;
+                    std::size_t d = 0;
+                    for (; d + 1 < draws; d += 2)
+                    {
+                        std::uint64_t randomBits = rng();
+                        double even = blockValues[((randomBits & 0xFFFFFFFFULL) * blockSize) >> 32] - shift;
+                        double odd = blockValues[((randomBits >> 32) * blockSize) >> 32] - shift;
+                        sumEven += even;
+                        squaresEven += even * even;
+                        sumOdd += odd;
+                        squaresOdd += odd * odd;
+                    }
+                    if (d < draws)
+                    {
+                        double last = blockValues[((rng() >> 32) * blockSize) >> 32] - shift;
+                        sumEven += last;
+                        squaresEven += last * last;
+                    }
+                    sum += sumEven + sumOdd;
+                    sumOfSquares += squaresEven + squaresOdd;
+                }
+
+                if (holdsMedian)
+                {
+                    std::size_t position = drawsBefore;
+                    for (std::size_t index = 0; index < blockSize; index++)
+                    {
+                        std::size_t nextPosition = position + countsInBlock[index];
+                        if (position <= lowMedianPosition && lowMedianPosition < nextPosition)
+                            lowMedian = blockValues[index];
+                        if (position <= highMedianPosition && highMedianPosition < nextPosition)
+                            highMedian = blockValues[index];
+                        position = nextPosition;
+                    }
+                }
+                drawsBefore += draws;
+            }
+
+            double centeredMean = sum / n;
+            double variance = n > 1 ? (sumOfSquares - sum * centeredMean) / (n - 1) : 0.0;
+            return ResampleStatistics {centeredMean + shift, (lowMedian + highMedian) / 2.0,
+                                       std::sqrt(std::max(0.0, variance))};
+        }
+
+    private:
+        const std::vector<T>& sortedValues;
+        double shift;
+        std::size_t blockCount;
+        std::vector<std::size_t> drawsPerBlock;
+        std::vector<std::uint32_t> countsInBlock;
+
+        std::size_t getBlockSize(std::size_t block) const
+        {
+            return std::min(BLOCK_SIZE, sortedValues.size() - block * BLOCK_SIZE);
+        }
+    };
+
+    /// Percentile interval of the bootstrap distribution. Sorts `samples` in place.
+    inline ConfidenceInterval percentileInterval(double estimate, std::vector<double>& samples, double level)
+    {
+        std::sort(samples.begin(), samples.end());
+        double alpha = (1.0 - level) / 2.0;
+        auto at = [&samples](double probability)
+        {
+            double rank = probability * (samples.size() - 1);
+            std::size_t low = static_cast<std::size_t>(std::floor(rank));
+            std::size_t high = std::min(low + 1, samples.size() - 1);
+            return samples[low] + (rank - low) * (samples[high] - samples[low]);
+        };
+        return ConfidenceInterval {estimate, at(alpha), at(1.0 - alpha)};
+    }
+}
+
+/** Percentile bootstrap confidence intervals for the mean, median and standard deviation.
+ *  Resample r always uses the random stream (seed, r), so the result only depends on
+ *  the seed and not on how the resamples are spread over threads.
+ */
+template <typename T>
+BootstrapResult bootstrapConfidenceIntervals(const std::vector<T>& sortedValues,
+                                             std::size_t resampleCount,
+                                             double confidenceLevel,
+                                             std::uint64_t seed,
+                                             std::size_t threadCount = std::thread::hardware_concurrency())
+{
+    using namespace bootstrap_detail;
+    if (sortedValues.empty() || resampleCount < 2)
+        throw UIExcept("Bootstrap needs at least one value and two resamples");
+    if (confidenceLevel <= 0.0 || confidenceLevel >= 1.0)
+        throw UIExcept("Confidence level must be between 0 and 1");
+
+    double shift = sortedValues[sortedValues.size() / 2];
+    std::vector<double> means(resampleCount), medians(resampleCount), deviations(resampleCount);
+
+    threadCount = std::max<std::size_t>(1, std::min(threadCount, resampleCount));
+    auto work = [&](std::size_t firstResample, std::size_t lastResample)
+    {
+        auto resampler = Resampler<T>(sortedValues, shift);
+        for (std::size_t r = firstResample; r < lastResample; r++)
+        {
+            auto rng = CounterRng(seed, r);
+            auto statistics = resampler.resample(rng);
+            means[r] = statistics.mean;
+            medians[r] = statistics.median;
+            deviations[r] = statistics.standardDeviation;
+        }
+    };
+
+    std::size_t perThread = (resampleCount + threadCount - 1) / threadCount;
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < threadCount; t++)
+        workers.emplace_back(work, std::min(resampleCount, t * perThread),
+                             std::min(resampleCount, (t + 1) * perThread));
+    work(0, std::min(resampleCount, perThread));
+    for (auto& worker : workers)
+        worker.join();
+
+    // Point estimates from the full data
+    const std::size_t n = sortedValues.size();
+    double sum = 0.0, sumOfSquares = 0.0;
+    for (const T& value : sortedValues)
+    {
+        double centered = value - shift;
+        sum += centered;
+        sumOfSquares += centered * centered;
+    }
+    double centeredMean = sum / n;
+    double deviation = n > 1 ? std::sqrt(std::max(0.0, (sumOfSquares - sum * centeredMean) / (n - 1))) : 0.0;
+    double median = (sortedValues[(n - 1) / 2] + sortedValues[n / 2]) / 2.0;
+
+    return BootstrapResult {
+        percentileInterval(centeredMean + shift, means, confidenceLevel),
+        percentileInterval(median, medians, confidenceLevel),
+        percentileInterval(deviation, deviations, confidenceLevel),
+        resampleCount,
+        confidenceLevel
+    };
+}
+
+#endif //PROJ1_BOOTSTRAP_H
@@ -0,0 +1,80 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_COUNTERRNG_H
+#define PROJ1_COUNTERRNG_H
+
+#include <cstdint>
+#include <limits>
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+/** Counter-based random number generator: the n-th output of a stream is a
+ *  pure function of (key, n), so any stream can be regenerated or split across
+ *  threads without sharing state. The mixing function is SplitMix64's finalizer.
+ *  Satisfies UniformRandomBitGenerator so it works with <random> distributions.
+ */
+class CounterRng
+{
+public:
+    using result_type = std::uint64_t;
+
+    explicit CounterRng(std::uint64_t seed, std::uint64_t stream = 0)
+        :
+        key {mix(seed ^ mix(stream + 0x632BE59BD9B4E019ULL))},
+        counter {0}
+    {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        return mix(key + 0x9E3779B97F4A7C15ULL * ++counter);
+    }
+
+    /// Uniform integer in [0, range) with Lemire's multiply-shift reduction.
+    std::uint64_t bounded(std::uint64_t range)
+    {
+        return multiplyHigh((*this)(), range);
+    }
+
+    /// Uniform double in [0, 1).
+    double uniform()
+    {
+        return ((*this)() >> 11) * 0x1.0p-53;
+    }
+
+private:
+    std::uint64_t key;
+    std::uint64_t counter;
+
+    /// High 64 bits of the 128 bit product a * b
+    static std::uint64_t multiplyHigh(std::uint64_t a, std::uint64_t b)
+    {
+#if defined(__SIZEOF_INT128__)
+        return static_cast<std::uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        return __umulh(a, b);
+#else
+        // schoolbook product of the 32 bit halves, the middle sum cannot overflow
+        std::uint64_t aLow = a & 0xFFFFFFFFULL, aHigh = a >> 32;
+        std::uint64_t bLow = b & 0xFFFFFFFFULL, bHigh = b >> 32;
+        std::uint64_t lowLow = aLow * bLow;
+        std::uint64_t highLow = aHigh * bLow;
+        std::uint64_t middle = (lowLow >> 32) + (highLow & 0xFFFFFFFFULL) + aLow * bHigh;
+        return aHigh * bHigh + (highLow >> 32) + (middle >> 32);
+#endif
+    }
+
+    static std::uint64_t mix(std::uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+#endif //PROJ1_COUNTERRNG_H
@@ -0,0 +1,229 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_FILEFOLLOWER_H
+#define PROJ1_FILEFOLLOWER_H
+
+#include <string>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include "ingestPipeline.h"
+#include "ui/UIExcept.h"
+
+/** Follows a file that producers keep appending to, like tail -f. Each call of readAppended
+ *  reads only the bytes written since the previous one. A number at the end that is not yet
+ *  followed by white space may still grow, so it waits for the next call.
+ *
+ *  inotify tells when the file changes. A file that shrinks was truncated and is read again
+ *  from the start. A file that is moved or deleted is read until a new file is created in
+ *  its place, which is then followed from its start. Either way the values read before are
+ *  no longer in the file, and readAppended calls restart before the values read again.
+ */
+class FileFollower
+{
+public:
+    explicit FileFollower(std::string _path) : path {std::move(_path)}
+    {
+        notifications = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (notifications < 0)
+            throw UIExcept("Cannot watch files");
+        if (!open())
+        {
+            ::close(notifications);
+            throw UIExcept("Cannot open file " + path);
+        }
+    }
+
+    FileFollower(const FileFollower&) = delete;
+    FileFollower& operator=(const FileFollower&) = delete;
+
+    ~FileFollower()
+    {
+        close();
+        ::close(notifications);
+    }
+
+    /// Wait at most timeoutMs for the file to change, false when it did not
+    bool waitForChange(int timeoutMs)
+    {
+        pollfd changes {notifications, POLLIN, 0};
+        if (fd < 0)
+        {
+            // the file is gone: look for it again now and then
+            ::poll(nullptr, 0, std::min(timeoutMs, REOPEN_INTERVAL_MS));
+            return open();
+        }
+        if (::poll(&changes, 1, timeoutMs) <= 0)
+            return false;
+
+        alignas(inotify_event) char events[4096];
+        ssize_t length;
+        while ((length = ::read(notifications, events, sizeof(events))) > 0)
+        {
+            for (ssize_t position = 0; position < length;)
+            {
+                auto event = reinterpret_cast<const inotify_event*>(events + position);
+                // events of a watch removed before are late, not about the file followed now
+                if (event->wd == watch && (event->mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED)))
+                    gone = true;
+                position += sizeof(inotify_event) + event->len;
+            }
+        }
+        return true;
+    }
+
+    /** Pass each value appended since the last call to consume, in file order. When the file
+     *  was truncated or replaced, restart() is called first: what consume was given before is
+     *  not in the file any more, and the file is read from its start. Returns the bytes read.
+     *  Tokens that are not numbers are skipped and counted.
+     */
+    template <typename T, typename Consume, typename Restart>
+    std::size_t readAppended(Consume consume, Restart restart)
+    {
+        using namespace ingest_detail;
+        if (fd < 0)
+            return 0;
+        struct stat status {};
+        if (::fstat(fd, &status) == 0 && static_cast<std::size_t>(status.st_size) < offset)
+        {
+            offset = 0;
+            pending.clear();
+            droppingToken = false;
+            truncations++;
+            restarted = true;
+        }
+        if (restarted)
+        {
+            restarted = false;
+            restart();
+        }
+
+        std::size_t bytesRead = 0;
+        char buffer[CHUNK_BYTES];
+        while (true)
+        {
+            ssize_t count = ::pread(fd, buffer, sizeof(buffer), static_cast<off_t>(offset));
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count < 0)
+                throw UIExcept("Cannot read file " + path + ": " + std::strerror(errno));
+            if (count == 0)
+                break;
+            offset += count;
+            bytesRead += count;
+            pending.append(buffer, count);
+            parseComplete<T>(consume);
+        }
+
+        // writers may still finish the old file, it is read until a new file takes its path
+        struct stat replacement {};
+        if (gone && ::stat(path.c_str(), &replacement) == 0 && replacement.st_ino != status.st_ino)
+        {
+            close();
+            if (open())
+                return bytesRead + readAppended<T>(consume, restart);
+        }
+        return bytesRead;
+    }
+
+    std::size_t getSkippedTokens() const
+    {
+        return skippedTokens;
+    }
+
+    std::size_t getTruncations() const
+    {
+        return truncations;
+    }
+
+private:
+    static constexpr int REOPEN_INTERVAL_MS = 500;
+    // a token longer than this is not a number, it is dropped instead of being kept whole
+    static constexpr std::size_t MAX_TOKEN_LENGTH = 64;
+
+    std::string path;
+    int notifications = -1;
+    int fd = -1;
+    int watch = -1;
+    bool gone = false;
+    std::size_t offset = 0;
+    // bytes read after the last white space
+    std::string pending;
+    // the rest of a token that was too long is dropped up to the next white space
+    bool droppingToken = false;
+    std::size_t skippedTokens = 0;
+    std::size_t truncations = 0;
+    // the file is read from its start again, and the values read before are dropped
+    bool restarted = false;
+    bool everOpened = false;
+
+    bool open()
+    {
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        restarted = everOpened;
+        everOpened = true;
+        watch = ::inotify_add_watch(notifications, path.c_str(),
+                                    IN_MODIFY | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF | IN_ATTRIB);
+        gone = false;
+        offset = 0;
+        pending.clear();
+        droppingToken = false;
+        return true;
+    }
+
+    void close()
+    {
+        if (watch >= 0)
+            ::inotify_rm_watch(notifications, watch);
+        if (fd >= 0)
+            ::close(fd);
+        watch = -1;
+        fd = -1;
+    }
+
+    /// Parse pending up to its last white space, keep the rest
+    template <typename T, typename Consume>
+    void parseComplete(Consume& consume)
+    {
+        using namespace ingest_detail;
+        if (droppingToken)
+        {
+            auto tokenEnd = std::find_if(pending.cbegin(), pending.cend(), isSpace);
+            droppingToken = tokenEnd == pending.cend();
+            pending.erase(pending.cbegin(), tokenEnd);
+        }
+        std::size_t complete = pending.size();
+        while (complete > 0 && !isSpace(pending[complete - 1]))
+            complete--;
+
+        const char* first = pending.data();
+        const char* last = first + complete;
+        T value;
+        Parsed parsed;
+        while ((parsed = parseNextToken(first, last, value)) != Parsed::End)
+        {
+            if (parsed == Parsed::Value)
+                consume(value);
+            else
+                skippedTokens++;
+        }
+        pending.erase(0, complete);
+        if (pending.size() > MAX_TOKEN_LENGTH)
+        {
+            pending.clear();
+            droppingToken = true;
+            skippedTokens++;
+        }
+    }
+};
+
+#endif //PROJ1_FILEFOLLOWER_H
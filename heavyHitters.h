@@ -0,0 +1,246 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_HEAVYHITTERS_H
+#define PROJ1_HEAVYHITTERS_H
+
+#include <vector>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <algorithm>
+#include <utility>
+
+/** Most frequent values of a stream, counting at most capacity distinct values (the
+ *  Space-Saving algorithm of Metwally, Agrawal and El Abbadi). A new value takes the place
+ *  of the least counted one and starts from its count, which becomes the error of the new
+ *  entry: a count is never below the true frequency and at most error above it.
+ *
+ *  Every value that occurs more than count / capacity times is kept. The counts are exact
+ *  as long as no value was replaced.
+ */
+template <typename T>
+class HeavyHitters
+{
+public:
+    struct Entry
+    {
+        T value;
+        std::size_t count;
+        // at most this much of count may belong to values replaced before
+        std::size_t error;
+    };
+
+    explicit HeavyHitters(std::size_t _capacity = 1024) : capacity {std::max<std::size_t>(_capacity, 1)}
+    {
+        entries.reserve(capacity);
+    }
+
+    /// The table of the entries saved, as getMostFrequent returned them
+    HeavyHitters(std::size_t _capacity, const std::vector<Entry>& saved, bool exact)
+        :
+        HeavyHitters(_capacity)
+    {
+        for (const auto& entry : saved)
+            insert(entry.value, Counted {entry.count, entry.error});
+        replaced = !exact;
+    }
+
+    // leastCounted points into entries, a copy finds its own least counted entries again
+    HeavyHitters(const HeavyHitters& other)
+        :
+        capacity {other.capacity},
+        entries {other.entries},
+        replaced {other.replaced}
+    {}
+
+    HeavyHitters(HeavyHitters&& other) noexcept
+        :
+        capacity {other.capacity},
+        entries {std::move(other.entries)},
+        replaced {other.replaced}
+    {
+        other.leastCounted.clear();
+    }
+
+    HeavyHitters& operator=(const HeavyHitters& other)
+    {
+        if (this != &other)
+        {
+            capacity = other.capacity;
+            entries = other.entries;
+            leastCounted.clear();
+            replaced = other.replaced;
+        }
+        return *this;
+    }
+
+    HeavyHitters& operator=(HeavyHitters&& other) noexcept
+    {
+        if (this != &other)
+        {
+            capacity = other.capacity;
+            entries = std::move(other.entries);
+            leastCounted.clear();
+            other.leastCounted.clear();
+            replaced = other.replaced;
+        }
+        return *this;
+    }
+
+    void add(const T& value, std::size_t weight = 1)
+    {
+        auto entry = entries.find(value);
+        if (entry != entries.end())
+        {
+            entry->second.count += weight;
+            return;
+        }
+        if (entries.size() < capacity)
+        {
+            insert(value, Counted {weight, 0});
+            return;
+        }
+
+        // the node of the replaced value is reused, a new value costs no allocation
+        auto node = takeLeastCounted();
+        std::size_t replacedCount = node.mapped().count;
+        node.key() = value;
+        node.mapped() = Counted {replacedCount + weight, replacedCount};
+        entries.insert(std::move(node));
+        replaced = true;
+    }
+
+    /** Add the counts of other, the table of another part of the stream. A value that only
+     *  one table counts may have occurred in the other part as often as the least counted value
+     *  there, when that table replaced values; that much is added to its count and its error.
+     *  The capacity most counted values are kept.
+     */
+    void merge(const HeavyHitters& other)
+    {
+        std::size_t ownFloor = leastPossibleCount();
+        std::size_t otherFloor = other.leastPossibleCount();
+        std::vector<std::pair<T, Counted>> merged;
+        merged.reserve(entries.size() + other.entries.size());
+        for (const auto& [value, counted] : entries)
+        {
+            auto found = other.entries.find(value);
+            if (found != other.entries.end())
+                merged.push_back({value, Counted {counted.count + found->second.count,
+                                                  counted.error + found->second.error}});
+            else
+                merged.push_back({value, Counted {counted.count + otherFloor, counted.error + otherFloor}});
+        }
+        for (const auto& [value, counted] : other.entries)
+            if (entries.find(value) == entries.end())
+                merged.push_back({value, Counted {counted.count + ownFloor, counted.error + ownFloor}});
+
+        replaced = replaced || other.replaced || merged.size() > capacity;
+        if (merged.size() > capacity)
+        {
+            auto moreCounted = [](const std::pair<T, Counted>& a, const std::pair<T, Counted>& b)
+            {
+                return a.second.count != b.second.count ? a.second.count > b.second.count : a.first < b.first;
+            };
+            std::nth_element(merged.begin(), merged.begin() + capacity, merged.end(), moreCounted);
+            merged.resize(capacity);
+        }
+        entries.clear();
+        for (const auto& [value, counted] : merged)
+            insert(value, counted);
+    }
+
+    bool isExact() const
+    {
+        return !replaced;
+    }
+
+    std::size_t getCapacity() const
+    {
+        return capacity;
+    }
+
+    /// The count most counted values, most counted first and smaller values first on ties
+    std::vector<Entry> getMostFrequent(std::size_t count) const
+    {
+        std::vector<Entry> mostFrequent;
+        for (const auto& [value, counted] : entries)
+            mostFrequent.push_back(Entry {value, counted.count, counted.error});
+        auto moreFrequent = [](const Entry& a, const Entry& b)
+        {
+            return a.count != b.count ? a.count > b.count : a.value < b.value;
+        };
+        count = std::min(count, mostFrequent.size());
+        std::partial_sort(mostFrequent.begin(), mostFrequent.begin() + count, mostFrequent.end(), moreFrequent);
+        mostFrequent.resize(count);
+        return mostFrequent;
+    }
+
+private:
+    struct Counted
+    {
+        std::size_t count;
+        std::size_t error;
+    };
+
+    std::size_t capacity;
+    std::unordered_map<T, Counted> entries;
+    // the entries counted leastCount times, the largest value first, which are replaced from the
+    // back; an entry counted again since it was put in is passed over. The table has its full
+    // size by then, so it is not rehashed and the iterators stay valid.
+    std::vector<typename std::unordered_map<T, Counted>::iterator> leastCounted;
+    std::size_t leastCount = 0;
+    bool replaced = false;
+
+    void insert(const T& value, Counted counted)
+    {
+        entries.emplace(value, counted);
+        leastCounted.clear();
+    }
+
+    /// Take the least counted entry out of the table, the smaller value on ties
+    typename std::unordered_map<T, Counted>::node_type takeLeastCounted()
+    {
+        while (true)
+        {
+            if (leastCounted.empty())
+                findLeastCounted();
+            auto entry = leastCounted.back();
+            leastCounted.pop_back();
+            if (entry->second.count == leastCount)
+                return entries.extract(entry);
+        }
+    }
+
+    /// A value that replaces another is counted more than leastCount, so this is seldom needed again
+    void findLeastCounted()
+    {
+        leastCount = std::numeric_limits<std::size_t>::max();
+        for (auto entry = entries.begin(); entry != entries.end(); entry++)
+        {
+            if (entry->second.count < leastCount)
+            {
+                leastCount = entry->second.count;
+                leastCounted.clear();
+            }
+            if (entry->second.count == leastCount)
+                leastCounted.push_back(entry);
+        }
+        std::sort(leastCounted.begin(), leastCounted.end(),
+                  [](const auto& a, const auto& b) { return a->first > b->first; });
+    }
+
+    /// Most times a value that is not counted may have occurred
+    std::size_t leastPossibleCount() const
+    {
+        if (!replaced || entries.empty())
+            return 0;
+        std::size_t least = entries.cbegin()->second.count;
+        for (const auto& [value, counted] : entries)
+            least = std::min(least, counted.count);
+        return least;
+    }
+};
+
+#endif //PROJ1_HEAVYHITTERS_H
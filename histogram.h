@@ -0,0 +1,267 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_HISTOGRAM_H
+#define PROJ1_HISTOGRAM_H
+
+#include <vector>
+#include <thread>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <numeric>
+#include "ui/UIExcept.h"
+
+enum class BinningScheme
+{
+    FixedWidth,
+    LogScale,
+    Quantile
+};
+
+struct Histogram
+{
+    // edges.size() == counts.size() + 1, bin i covers [edges[i], edges[i + 1])
+    // and the last bin also includes its upper edge.
+    std::vector<double> edges;
+    std::vector<long> counts;
+
+    std::size_t getBinCount() const { return counts.size(); }
+
+    long getTotalCount() const
+    {
+        return std::accumulate(counts.cbegin(), counts.cend(), 0L);
+    }
+};
+
+namespace histogram_detail
+{
+    // Elements per chunk of bucket indices. Large enough to amortize the loop overhead,
+    // small enough to stay in L1 together with the sub-histogram.
+    constexpr std::size_t CHUNK_SIZE = 1024;
+    // Below this many elements per thread it is not worth starting a thread.
+    constexpr std::size_t MIN_ELEMENTS_PER_THREAD = 1 << 16;
+
+    /// Counts of one thread. Aligned so that two threads never write to the same cache line.
+    struct alignas(64) SubHistogram
+    {
+        std::vector<long> counts;
+    };
+
+    /** Bucket index of each value in an affine space, floor((f(x) - offset) * scale)
+     *  clamped to [0, lastBin]. The loop has no branches and no dependency between
+     *  iterations so the compiler emits SIMD code for it.
+     */
+    template <typename T, typename Transform>
+    void assignAffineBuckets(const T* values, std::size_t n, Transform transform,
+                             double offset, double scale, std::uint32_t lastBin,
+                             std::uint32_t* bucketIndices)
+    {
+        const double lastBinValue = lastBin;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            double position = (transform(static_cast<double>(values[i])) - offset) * scale;
+            position = position < 0.0 ? 0.0 : position;
+            position = position > lastBinValue ? lastBinValue : position;
+            bucketIndices[i] = static_cast<std::uint32_t>(position);
+        }
+    }
+
+    /** Rounding in the affine mapping can put a value that sits right on an edge into
+     *  the neighbouring bucket. Move such values so the counts agree with the edges.
+     */
+    template <typename T>
+    void correctBucketsAgainstEdges(const T* values, std::size_t n, const std::vector<double>& edges,
+                                    std::uint32_t lastBin, std::uint32_t* bucketIndices)
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            double value = values[i];
+            std::uint32_t index = bucketIndices[i];
+            index -= (index > 0 && value < edges[index]) ? 1 : 0;
+            index += (index < lastBin && value >= edges[index + 1]) ? 1 : 0;
+            bucketIndices[i] = index;
+        }
+    }
+
+    /// Bucket index of each value for arbitrary edges, with a branchless binary search.
+    template <typename T>
+    void assignSearchedBuckets(const T* values, std::size_t n, const std::vector<double>& edges,
+                               std::uint32_t* bucketIndices)
+    {
+        // Only the inner edges decide the bucket: index = number of inner edges <= value.
+        const double* innerEdges = edges.data() + 1;
+        const std::size_t innerEdgeCount = edges.size() - 2;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            double value = values[i];
+            if (innerEdgeCount == 0)
+            {
+                bucketIndices[i] = 0;
+                continue;
+            }
+            const double* first = innerEdges;
+            std::size_t length = innerEdgeCount;
+            while (length > 1)
+            {
+                std::size_t half = length / 2;
+                first += first[half - 1] <= value ? half : 0;
+                length -= half;
+            }
+            bucketIndices[i] = static_cast<std::uint32_t>(first - innerEdges + (*first <= value ? 1 : 0));
+        }
+    }
+
+    template <typename T, typename BucketAssigner>
+    void countRange(const T* values, std::size_t n, BucketAssigner assignBuckets, std::vector<long>& counts)
+    {
+        std::uint32_t bucketIndices[CHUNK_SIZE];
+        for (std::size_t chunkStart = 0; chunkStart < n; chunkStart += CHUNK_SIZE)
+        {
+            std::size_t chunkSize = std::min(CHUNK_SIZE, n - chunkStart);
+            assignBuckets(values + chunkStart, chunkSize, bucketIndices);
+            for (std::size_t i = 0; i < chunkSize; i++)
+                counts[bucketIndices[i]]++;
+        }
+    }
+
+    /// Split the values across threads, each counting into a private sub-histogram, then merge.
+    template <typename T, typename BucketAssigner>
+    std::vector<long> parallelCount(const T* values, std::size_t n, std::size_t binCount,
+                                    BucketAssigner assignBuckets)
+    {
+        std::size_t threadCount = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+        threadCount = std::max<std::size_t>(1, std::min(threadCount, n / MIN_ELEMENTS_PER_THREAD));
+
+        std::vector<SubHistogram> subHistograms(threadCount);
+        for (auto& subHistogram : subHistograms)
+            subHistogram.counts.assign(binCount, 0);
+
+        std::size_t perThread = (n + threadCount - 1) / threadCount;
+        std::vector<std::thread> workers;
+        for (std::size_t t = 1; t < threadCount; t++)
+        {
+            std::size_t begin = std::min(n, t * perThread);
+            std::size_t end = std::min(n, begin + perThread);
+            workers.emplace_back([=, &subHistograms]()
+            {
+                countRange(values + begin, end - begin, assignBuckets, subHistograms[t].counts);
+            });
+        }
+        countRange(values, std::min(n, perThread), assignBuckets, subHistograms[0].counts);
+        for (auto& worker : workers)
+            worker.join();
+
+        auto counts = std::move(subHistograms[0].counts);
+        for (std::size_t t = 1; t < threadCount; t++)
+            for (std::size_t bin = 0; bin < binCount; bin++)
+                counts[bin] += subHistograms[t].counts[bin];
+        return counts;
+    }
+}
+
+/** Histogram of values[0, n). Values must be sorted when using BinningScheme::Quantile,
+ *  the other schemes accept any order.
+ */
+template <typename T>
+Histogram buildHistogram(const T* values, std::size_t n, BinningScheme scheme, std::size_t binCount)
+{
+    using namespace histogram_detail;
+    if (n == 0 || binCount == 0)
+        throw UIExcept("Histogram needs at least one value and one bin");
+
+    auto [minIt, maxIt] = std::minmax_element(values, values + n);
+    double low = *minIt, high = *maxIt;
+    auto histogram = Histogram();
+    histogram.edges.resize(binCount + 1);
+    auto lastBin = static_cast<std::uint32_t>(binCount - 1);
+
+    switch (scheme)
+    {
+        case BinningScheme::FixedWidth:
+        {
+            double width = (high - low) / binCount;
+            for (std::size_t i = 0; i <= binCount; i++)
+                histogram.edges[i] = low + width * i;
+            histogram.edges.back() = high;
+            double scale = width > 0.0 ? 1.0 / width : 0.0;
+            const auto& edges = histogram.edges;
+            histogram.counts = parallelCount(values, n, binCount,
+                [=, &edges](const T* chunk, std::size_t size, std::uint32_t* indices)
+                {
+                    assignAffineBuckets(chunk, size, [](double x) { return x; }, low, scale, lastBin, indices);
+                    correctBucketsAgainstEdges(chunk, size, edges, lastBin, indices);
+                });
+            break;
+        }
+        case BinningScheme::LogScale:
+        {
+            if (low <= 0.0)
+                throw UIExcept("Log-scale bins require positive values");
+            double logLow = std::log(low), logHigh = std::log(high);
+            double logWidth = (logHigh - logLow) / binCount;
+            for (std::size_t i = 0; i <= binCount; i++)
+                histogram.edges[i] = std::exp(logLow + logWidth * i);
+            histogram.edges.front() = low;
+            histogram.edges.back() = high;
+            double scale = logWidth > 0.0 ? 1.0 / logWidth : 0.0;
+            const auto& edges = histogram.edges;
+            histogram.counts = parallelCount(values, n, binCount,
+                [=, &edges](const T* chunk, std::size_t size, std::uint32_t* indices)
+                {
+                    assignAffineBuckets(chunk, size, [](double x) { return std::log(x); }, logLow, scale, lastBin, indices);
+                    correctBucketsAgainstEdges(chunk, size, edges, lastBin, indices);
+                });
+            break;
+        }
+        case BinningScheme::Quantile:
+        {
+            for (std::size_t i = 0; i < binCount; i++)
+                histogram.edges[i] = values[i * n / binCount];
+            histogram.edges.back() = high;
+            const auto& edges = histogram.edges;
+            histogram.counts = parallelCount(values, n, binCount,
+                [&edges](const T* chunk, std::size_t size, std::uint32_t* indices)
+                {
+                    assignSearchedBuckets(chunk, size, edges, indices);
+                });
+            break;
+        }
+    }
+    return histogram;
+}
+
+/** Fixed width histogram of sorted values, with the same edges and counts as
+ *  BinningScheme::FixedWidth. Every count is found by binary search, so the cost is
+ *  O(binCount log n) instead of a pass over the values.
+ */
+template <typename T>
+Histogram buildSortedHistogram(const T* sortedValues, std::size_t n, std::size_t binCount)
+{
+    if (n == 0 || binCount == 0)
+        throw UIExcept("Histogram needs at least one value and one bin");
+
+    double low = sortedValues[0], high = sortedValues[n - 1];
+    double width = (high - low) / binCount;
+    auto histogram = Histogram();
+    histogram.edges.resize(binCount + 1);
+    for (std::size_t i = 0; i <= binCount; i++)
+        histogram.edges[i] = low + width * i;
+    histogram.edges.back() = high;
+
+    histogram.counts.resize(binCount);
+    const T* binStart = sortedValues;
+    for (std::size_t i = 0; i < binCount; i++)
+    {
+        // the last bin also takes the values equal to its upper edge
+        const T* binEnd = i + 1 == binCount ? sortedValues + n
+                        : std::lower_bound(binStart, sortedValues + n, histogram.edges[i + 1],
+                                           [](const T& value, double edge) { return value < edge; });
+        histogram.counts[i] = binEnd - binStart;
+        binStart = binEnd;
+    }
+    return histogram;
+}
+
+#endif //PROJ1_HISTOGRAM_H
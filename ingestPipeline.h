@@ -0,0 +1,365 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_INGESTPIPELINE_H
+#define PROJ1_INGESTPIPELINE_H
+
+#include <vector>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "spscRing.h"
+#include "ui/UIExcept.h"
+
+/// Work of one stage of an IngestPipeline
+struct StageCounters
+{
+    // bytes for the reading stage, values for the others
+    std::atomic<std::size_t> processed {0};
+    // times the stage had to wait, for input or for room in the next stage
+    std::atomic<std::size_t> stalls {0};
+};
+
+struct IngestCounters
+{
+    StageCounters reading, parsing, accumulating;
+};
+
+namespace ingest_detail
+{
+    constexpr std::size_t CHUNK_BYTES = 1 << 16;
+    constexpr std::size_t CHUNKS_IN_FLIGHT = 8;
+    constexpr std::size_t BATCH_VALUES = 4096;
+    constexpr std::size_t BATCHES_IN_FLIGHT = 8;
+    // how often a reader of a pipe or a terminal checks that it should stop
+    constexpr int POLL_INTERVAL_MS = 100;
+
+    inline bool isSpace(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    enum class Parsed
+    {
+        Value,
+        End,
+        Invalid
+    };
+
+    /// The next value of [first, last) as operator>> reads it: after white space, with an optional sign
+    template <typename T>
+    Parsed parseNext(const char*& first, const char* last, T& value)
+    {
+        while (first != last && isSpace(*first))
+            first++;
+        if (first == last)
+            return Parsed::End;
+        const char* start = first;
+        // from_chars takes no plus sign
+        if (*start == '+' && last - start > 1 && start[1] != '-')
+            start++;
+        auto [end, error] = std::from_chars(start, last, value);
+        if (error != std::errc())
+            return Parsed::Invalid;
+        first = end;
+        return Parsed::Value;
+    }
+
+    /** The next white space separated token of [first, last), a Value only when all of it is a
+     *  number: "12abc" is Invalid, not 12. first is past the token either way.
+     */
+    template <typename T>
+    Parsed parseNextToken(const char*& first, const char* last, T& value)
+    {
+        Parsed parsed = parseNext(first, last, value);
+        if (parsed == Parsed::End || (parsed == Parsed::Value && (first == last || isSpace(*first))))
+            return parsed;
+        while (first != last && !isSpace(*first))
+            first++;
+        return Parsed::Invalid;
+    }
+}
+
+/** Reads numbers from a file descriptor in three stages that overlap: a reading thread, a
+ *  parsing thread and the thread that takes the batches of values with next(). The stages
+ *  are connected by SpscRings of buffers that go round, so the pipeline holds a fixed amount
+ *  of memory however long the stream is. A stage that gets ahead waits for the next one.
+ *
+ *  The reader cuts the stream after white space, so no number is split between two chunks;
+ *  only a token longer than a chunk is. Like operator>>, parsing stops at the first text
+ *  that is not a number.
+ */
+template <typename T>
+class IngestPipeline
+{
+public:
+    /// Start reading fd, which is left open
+    IngestPipeline(int _fd, IngestCounters& _counters)
+        :
+        fd {_fd},
+        counters {_counters},
+        fullChunks {ingest_detail::CHUNKS_IN_FLIGHT},
+        freeChunks {ingest_detail::CHUNKS_IN_FLIGHT},
+        fullBatches {ingest_detail::BATCHES_IN_FLIGHT},
+        freeBatches {ingest_detail::BATCHES_IN_FLIGHT}
+    {
+        using namespace ingest_detail;
+        // every buffer is made here, the stages only pass them around
+        for (std::size_t i = 0; i < CHUNKS_IN_FLIGHT; i++)
+        {
+            auto chunk = Chunk {std::make_unique<char[]>(CHUNK_BYTES), 0};
+            freeChunks.tryPush(chunk);
+        }
+        for (std::size_t i = 0; i < BATCHES_IN_FLIGHT; i++)
+        {
+            std::vector<T> batch;
+            batch.reserve(BATCH_VALUES);
+            freeBatches.tryPush(batch);
+        }
+        struct stat status {};
+        pollBeforeRead = ::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode);
+        reader = std::thread(&IngestPipeline::read, this);
+        parser = std::thread(&IngestPipeline::parse, this);
+    }
+
+    IngestPipeline(const IngestPipeline&) = delete;
+    IngestPipeline& operator=(const IngestPipeline&) = delete;
+
+    /// Stops the stages, also when the values were not all taken
+    ~IngestPipeline()
+    {
+        stopping.store(true, std::memory_order_relaxed);
+        reader.join();
+        parser.join();
+    }
+
+    /** The next batch of values, in stream order, false at the end of the stream. Give the
+     *  batch back with recycle before asking for the next one. Throws when the stream could
+     *  not be read, after the values read before the error.
+     */
+    bool next(std::vector<T>& batch)
+    {
+        auto backoff = Backoff();
+        bool stalled = false;
+        while (!fullBatches.tryPop(batch))
+        {
+            if (parsingDone.load(std::memory_order_acquire))
+            {
+                if (fullBatches.tryPop(batch))
+                    break;
+                if (readError.has_value())
+                    throw UIExcept(readError.value());
+                return false;
+            }
+            if (!stalled)
+                counters.accumulating.stalls++;
+            stalled = true;
+            backoff.pause();
+        }
+        counters.accumulating.processed += batch.size();
+        return true;
+    }
+
+    void recycle(std::vector<T>& batch)
+    {
+        batch.clear();
+        freeBatches.tryPush(batch);
+    }
+
+private:
+    struct Chunk
+    {
+        std::unique_ptr<char[]> data;
+        std::size_t size;
+    };
+
+    int fd;
+    IngestCounters& counters;
+    bool pollBeforeRead;
+    SpscRing<Chunk> fullChunks, freeChunks;
+    SpscRing<std::vector<T>> fullBatches, freeBatches;
+    std::atomic<bool> stopping {false};
+    // the parser takes no more chunks
+    std::atomic<bool> parserFinished {false};
+    std::atomic<bool> readingDone {false};
+    std::atomic<bool> parsingDone {false};
+    // set by the reader before readingDone
+    std::optional<std::string> readError;
+    std::thread reader, parser;
+
+    bool shouldStop() const
+    {
+        return stopping.load(std::memory_order_relaxed) || parserFinished.load(std::memory_order_relaxed);
+    }
+
+    /// Take an item of ring, waiting while it is empty. false when the pipeline stops first.
+    template <typename Item, typename Done>
+    bool take(SpscRing<Item>& ring, Item& item, StageCounters& stage, Done isDone)
+    {
+        auto backoff = Backoff();
+        bool stalled = false;
+        while (!ring.tryPop(item))
+        {
+            if (isDone())
+                return ring.tryPop(item);
+            if (!stalled)
+                stage.stalls++;
+            stalled = true;
+            backoff.pause();
+        }
+        return true;
+    }
+
+    /// Put item in ring, waiting while it is full. false when the pipeline stops first.
+    template <typename Item, typename Stop>
+    bool give(SpscRing<Item>& ring, Item& item, StageCounters& stage, Stop shouldGiveUp)
+    {
+        auto backoff = Backoff();
+        bool stalled = false;
+        while (!ring.tryPush(item))
+        {
+            if (shouldGiveUp())
+                return false;
+            if (!stalled)
+                stage.stalls++;
+            stalled = true;
+            backoff.pause();
+        }
+        return true;
+    }
+
+    /// Bytes read into buffer, 0 at the end of the stream or when the pipeline stops
+    std::size_t readSome(char* buffer, std::size_t size)
+    {
+        while (!shouldStop())
+        {
+            if (pollBeforeRead)
+            {
+                // a pipe may stay silent for long, the reader must still notice that it should stop
+                pollfd input {fd, POLLIN, 0};
+                if (::poll(&input, 1, ingest_detail::POLL_INTERVAL_MS) == 0)
+                    continue;
+            }
+            ssize_t count = ::read(fd, buffer, size);
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count < 0)
+            {
+                readError = std::string("Cannot read input: ") + std::strerror(errno);
+                return 0;
+            }
+            counters.reading.processed += count;
+            return count;
+        }
+        return 0;
+    }
+
+    void read()
+    {
+        using namespace ingest_detail;
+        auto giveUp = [this] { return shouldStop(); };
+        Chunk chunk;
+        std::size_t filled = 0;
+        bool haveChunk = take(freeChunks, chunk, counters.reading, giveUp);
+        while (haveChunk)
+        {
+            std::size_t count = readSome(chunk.data.get() + filled, CHUNK_BYTES - filled);
+            filled += count;
+            if (count == 0)
+            {
+                chunk.size = filled;
+                if (filled > 0)
+                    give(fullChunks, chunk, counters.reading, giveUp);
+                break;
+            }
+
+            // the chunk ends after its last white space, the token cut at its end starts the next one
+            std::size_t cut = filled;
+            while (cut > 0 && !isSpace(chunk.data[cut - 1]))
+                cut--;
+            if (cut == 0)
+            {
+                if (filled < CHUNK_BYTES)
+                    continue;
+                cut = filled;
+            }
+            Chunk next;
+            if (!take(freeChunks, next, counters.reading, giveUp))
+                break;
+            std::memcpy(next.data.get(), chunk.data.get() + cut, filled - cut);
+            chunk.size = cut;
+            filled -= cut;
+            if (!give(fullChunks, chunk, counters.reading, giveUp))
+                break;
+            chunk = std::move(next);
+        }
+        readingDone.store(true, std::memory_order_release);
+    }
+
+    void parse()
+    {
+        using namespace ingest_detail;
+        auto giveUp = [this] { return stopping.load(std::memory_order_relaxed); };
+        std::vector<T> batch;
+        bool running = take(freeBatches, batch, counters.parsing, giveUp);
+        Chunk chunk;
+        while (running && take(fullChunks, chunk, counters.parsing,
+                               [this] { return readingDone.load(std::memory_order_acquire); }))
+        {
+            const char* first = chunk.data.get();
+            const char* last = first + chunk.size;
+            T value;
+            Parsed parsed = Parsed::End;
+            while (running && (parsed = parseNext(first, last, value)) == Parsed::Value)
+            {
+                batch.push_back(value);
+                if (batch.size() < BATCH_VALUES)
+                    continue;
+                counters.parsing.processed += batch.size();
+                running = give(fullBatches, batch, counters.parsing, giveUp)
+                          && take(freeBatches, batch, counters.parsing, giveUp);
+            }
+            // like operator>>, the values end at the first text that is not a number
+            if (parsed == Parsed::Invalid)
+                running = false;
+            freeChunks.tryPush(chunk);
+        }
+        parserFinished.store(true, std::memory_order_relaxed);
+        if (!batch.empty())
+        {
+            counters.parsing.processed += batch.size();
+            give(fullBatches, batch, counters.parsing, giveUp);
+        }
+        // the reader stops too, and the error it may have set is published with parsingDone
+        while (!readingDone.load(std::memory_order_acquire))
+            std::this_thread::yield();
+        parsingDone.store(true, std::memory_order_release);
+    }
+};
+
+/** Pass the values read from fd to consume, a const std::vector<T>& batch at a time, on this
+ *  thread while the next values are read and parsed. An exception thrown by consume stops
+ *  the pipeline and is passed on.
+ */
+template <typename T, typename Consume>
+void ingestValues(int fd, IngestCounters& counters, Consume consume)
+{
+    IngestPipeline<T> pipeline(fd, counters);
+    std::vector<T> batch;
+    while (pipeline.next(batch))
+    {
+        consume(static_cast<const std::vector<T>&>(batch));
+        pipeline.recycle(batch);
+    }
+}
+
+#endif //PROJ1_INGESTPIPELINE_H
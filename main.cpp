@@ -9,9 +9,494 @@
 #include "statisticsUI.h"
 #include <type_traits>
 #include "ui/MixedColumn.h"
+#include "reportWriter.h"
+#include "batchReport.h"
+#include "queryServer.h"
+#include "ingestPipeline.h"
+#include "fileFollower.h"
+#include "streamSummary.h"
+#include "shardedSummary.h"
+#include "summaryFile.h"
 
-int main()
+/// proj1 --report <table|csv|json|binary> <data file> [output file]
+/// Writes the report without the interactive menu, to stdout when no output file is given.
+int writeReportFromArguments(int argc, char** argv)
 {
+    auto format = argc >= 4 ? reportFormatFromName(argv[2]) : std::nullopt;
+    if (!format.has_value() || argc > 5)
+    {
+        std::cerr << "Usage: " << argv[0] << " --report <table|csv|json|binary> <data file> [output file]" << std::endl;
+        return 2;
+    }
+    try
+    {
+        auto ui = StatsUI();
+        // the report has no range statistics
+        ui.keepLoadOrder(false);
+        ui.loadDataFromFilePath(argv[3]);
+        if (ui.getSize() == 0)
+            throw UIExcept("No elements in array");
+        int fd = argc == 5 ? ::open(argv[4], O_WRONLY | O_CREAT | O_TRUNC, 0644) : STDOUT_FILENO;
+        if (fd < 0)
+            throw UIExcept("Cannot open file");
+        auto out = FileDescriptorSink(fd, fd != STDOUT_FILENO);
+        ui.report().write(format.value(), out);
+    }
+    catch (UIExcept& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/// proj1 --batch <option> [parameters...] ...
+/// proj1 --script <script file, - for stdin>
+/// Runs options without menus or prompts, see OptionUI::runScript for the exit status.
+int runScriptFromArguments(int argc, char** argv)
+{
+    bool fromFile = std::string(argv[1]) == "--script";
+    if (fromFile && argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " --script <script file, - for stdin>" << std::endl;
+        return 2;
+    }
+    auto ui = StatsUI();
+    int status;
+    try
+    {
+        std::optional<ScriptInput> script;
+        if (!fromFile)
+            script = ScriptInput::fromArguments(argc, argv, 2);
+        else if (std::string(argv[2]) == "-")
+            script = ScriptInput::fromStream(std::cin);
+        else
+        {
+            auto scriptFile = std::ifstream(argv[2]);
+            if (!scriptFile.is_open())
+                throw ScriptError(std::string("Cannot open script ") + argv[2]);
+            script = ScriptInput::fromStream(scriptFile);
+        }
+        status = ui.runScript(script.value());
+    }
+    catch (ScriptError& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 2;
+    }
+    if (!ui.finishFileWrites() && status == 0)
+        status = 1;
+    return status;
+}
+
+/// proj1 --summarize <table|csv|json> [--threads n] [--memory-mb m] <file, glob or @list>...
+/// One summary row per file on stdout. Exits with 1 when a file could not be analyzed.
+int summarizeFilesFromArguments(int argc, char** argv)
+{
+    auto usage = [argv]()
+    {
+        std::cerr << "Usage: " << argv[0] << " --summarize <table|csv|json> [--threads n] [--memory-mb m]"
+                  << " <file, glob or @list>..." << std::endl;
+        return 2;
+    };
+    auto format = argc >= 3 ? reportFormatFromName(argv[2]) : std::nullopt;
+    if (!format.has_value() || format == ReportFormat::Binary)
+        return usage();
+
+    std::size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t memoryLimit = config::BATCH_MEMORY_LIMIT_MB << 20;
+    std::vector<std::string> arguments;
+    for (int i = 3; i < argc; i++)
+    {
+        auto argument = std::string(argv[i]);
+        if (argument == "--threads" || argument == "--memory-mb")
+        {
+            long value = i + 1 < argc ? std::atol(argv[++i]) : 0;
+            if (value <= 0)
+                return usage();
+            if (argument == "--threads")
+                threadCount = static_cast<std::size_t>(value);
+            else
+                memoryLimit = static_cast<std::size_t>(value) << 20;
+        }
+        else
+            arguments.push_back(argument);
+    }
+
+    try
+    {
+        auto paths = expandFileArguments(arguments);
+        if (paths.empty())
+            return usage();
+        auto summaries = summarizeFiles(paths, threadCount, memoryLimit);
+        auto out = FileDescriptorSink(STDOUT_FILENO);
+        writeBatchSummary(format.value(), summaries, out);
+        bool failed = std::any_of(summaries.cbegin(), summaries.cend(),
+                                  [](const FileSummary& summary) { return summary.error.has_value(); });
+        return failed ? 1 : 0;
+    }
+    catch (UIExcept& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+/// proj1 --serve <socket path> [--threads n] [name=data file]...
+/// Keeps the datasets loaded and answers queries on the socket until SIGINT or SIGTERM.
+int serveFromArguments(int argc, char** argv)
+{
+    auto usage = [argv]()
+    {
+        std::cerr << "Usage: " << argv[0] << " --serve <socket path> [--threads n] [name=data file]..." << std::endl;
+        return 2;
+    };
+    if (argc < 3)
+        return usage();
+
+    std::size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::pair<std::string, std::string>> preloads;
+    for (int i = 3; i < argc; i++)
+    {
+        auto argument = std::string(argv[i]);
+        auto separator = argument.find('=');
+        if (argument == "--threads")
+        {
+            long value = i + 1 < argc ? std::atol(argv[++i]) : 0;
+            if (value <= 0)
+                return usage();
+            threadCount = static_cast<std::size_t>(value);
+        }
+        else if (separator != std::string::npos && separator > 0)
+            preloads.emplace_back(argument.substr(0, separator), argument.substr(separator + 1));
+        else
+            return usage();
+    }
+
+    try
+    {
+        auto server = QueryServer(argv[2], threadCount);
+        for (const auto& [name, path] : preloads)
+            server.getDatasets().load(name, path);
+        server.run();
+    }
+    catch (UIExcept& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/// proj1 --query <socket path> <request words>...
+/// Sends one request to a server and prints its reply. Exits with 1 when the reply is an error.
+int queryFromArguments(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " --query <socket path> <request words>..." << std::endl;
+        return 2;
+    }
+    std::string request = argv[3];
+    for (int i = 4; i < argc; i++)
+        request += std::string(" ") + argv[i];
+    try
+    {
+        auto reply = queryServer(argv[2], request);
+        auto out = FileDescriptorSink(STDOUT_FILENO);
+        out.write(reply);
+        return reply.compare(0, 3, "OK ") == 0 ? 0 : 1;
+    }
+    catch (UIExcept& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+/// proj1 --ingest <data file, - for stdin>
+/// Streams the values through the ingest pipeline into running moments, in constant memory,
+/// and shows them with what each stage of the pipeline did.
+int ingestFromArguments(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " --ingest <data file, - for stdin>" << std::endl;
+        return 2;
+    }
+    bool fromStdin = std::string(argv[2]) == "-";
+    int fd = fromStdin ? STDIN_FILENO : ::open(argv[2], O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        std::cerr << "ERROR: Cannot open file" << std::endl;
+        return 1;
+    }
+
+    auto counters = IngestCounters();
+    auto moments = Moments<long>();
+    auto start = std::chrono::steady_clock::now();
+    try
+    {
+        ingestValues<long>(fd, counters, [&moments](const std::vector<long>& batch)
+        {
+            for (long value : batch)
+                moments.add(value);
+        });
+    }
+    catch (UIExcept& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!fromStdin)
+        ::close(fd);
+
+    using ValuesTable = TypedTable<Col<std::size_t>, Col<std::optional<long>>, Col<std::optional<long>>,
+                                   Col<std::optional<double>>, Col<std::optional<double>>>;
+    using StagesTable = TypedTable<Col<const char*>, Col<std::size_t>, Col<const char*>, Col<double>, Col<std::size_t>>;
+    auto arena = RenderArena();
+    auto values = arena.create<ValuesTable>(
+        ValuesTable::Columns {{L"Count"}, {L"Minimum"}, {L"Maximum"}, {L"Mean"}, {L"Std Dev"}}, L"Values");
+    auto some = [&moments](auto value) { return moments.count > 0 ? std::make_optional(value) : std::nullopt; };
+    values->addRow(moments.count, some(moments.min), some(moments.max), some(moments.mean),
+                   some(moments.getStandardDeviation()));
+    auto stages = arena.create<StagesTable>(
+        StagesTable::Columns {{L"Stage"}, {L"Processed"}, {L"Unit"}, {L"Per second"}, {L"Stalls"}},
+        L"Ingest in " + std::to_wstring(seconds) + L" s");
+    auto addStage = [&stages, seconds](const char* name, const StageCounters& stage, const char* unit)
+    {
+        std::size_t processed = stage.processed.load();
+        stages->addRow(name, processed, unit, seconds > 0 ? processed / seconds : 0.0, stage.stalls.load());
+    };
+    addStage("Reading", counters.reading, "bytes");
+    addStage("Parsing", counters.parsing, "values");
+    addStage("Accumulating", counters.accumulating, "values");
+
+    auto out = FileDescriptorSink(STDOUT_FILENO);
+    values->dumpTableTo(out);
+    stages->dumpTableTo(out);
+    return 0;
+}
+
+volatile std::sig_atomic_t watchInterrupted = 0;
+
+/// proj1 --watch <data file> [--interval ms]
+/// Follows a file that is being appended to and shows its summary, refreshed at most once per
+/// interval and only when values were added. Stops on SIGINT or SIGTERM.
+int watchFromArguments(int argc, char** argv)
+{
+    long interval = config::WATCH_INTERVAL_MS;
+    if (argc == 5 && std::string(argv[3]) == "--interval")
+        interval = std::atol(argv[4]);
+    if ((argc != 3 && argc != 5) || interval <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " --watch <data file> [--interval ms]" << std::endl;
+        return 2;
+    }
+
+    struct sigaction stopAction {};
+    stopAction.sa_handler = [](int) { watchInterrupted = 1; };
+    sigemptyset(&stopAction.sa_mask);
+    ::sigaction(SIGINT, &stopAction, nullptr);
+    ::sigaction(SIGTERM, &stopAction, nullptr);
+
+    try
+    {
+        auto follower = FileFollower(argv[2]);
+        auto summary = StreamSummary<long>();
+        auto out = FileDescriptorSink(STDOUT_FILENO);
+        bool toTerminal = ::isatty(STDOUT_FILENO);
+        auto nextRefresh = std::chrono::steady_clock::now();
+        bool changed = true;
+        std::size_t bytesRead = 0;
+        while (!watchInterrupted)
+        {
+            // the values summarized so far were truncated or replaced, the file is summarized again
+            auto restart = [&summary, &bytesRead, &changed]()
+            {
+                summary = StreamSummary<long>();
+                bytesRead = 0;
+                changed = true;
+            };
+            std::size_t appended = follower.readAppended<long>([&summary](long value) { summary.add(value); }, restart);
+            bytesRead += appended;
+            if (appended > 0)
+                changed = true;
+            auto now = std::chrono::steady_clock::now();
+            if (changed && now >= nextRefresh)
+            {
+                auto status = std::string(toTerminal ? "\x1b[H\x1b[2J" : "") + "Watching " + argv[2] + ": "
+                              + std::to_string(bytesRead) + " bytes read";
+                if (follower.getSkippedTokens() > 0)
+                    status += ", " + std::to_string(follower.getSkippedTokens()) + " tokens skipped";
+                if (follower.getTruncations() > 0)
+                    status += ", truncated " + std::to_string(follower.getTruncations()) + " times";
+                out.write(status + "\n");
+                writeStreamSummary(summary, L"Values", out);
+                changed = false;
+                nextRefresh = now + std::chrono::milliseconds(interval);
+            }
+            // a change wakes the wait at once, the values are then read but shown at the next refresh
+            auto untilRefresh = std::chrono::duration_cast<std::chrono::milliseconds>(nextRefresh - now).count();
+            follower.waitForChange(changed ? static_cast<int>(std::max<long long>(untilRefresh, 0)) : interval);
+        }
+    }
+    catch (UIExcept& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/// proj1 --sharded <table|csv|json|binary> <data file> [--processes n]
+/// Summarizes the file in worker processes, one shard of the file each, and writes the merged summary.
+int shardedFromArguments(int argc, char** argv)
+{
+    auto format = argc >= 4 ? reportFormatFromName(argv[2]) : std::nullopt;
+    long processCount = std::max(1u, std::thread::hardware_concurrency());
+    if (argc == 6 && std::string(argv[4]) == "--processes")
+        processCount = std::atol(argv[5]);
+    if (!format.has_value() || (argc != 4 && argc != 6) || processCount <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " --sharded <table|csv|json|binary> <data file> [--processes n]"
+                  << std::endl;
+        return 2;
+    }
+
+    try
+    {
+        auto sharded = summarizeInProcesses<long>(argv[3], static_cast<std::size_t>(processCount));
+        auto out = FileDescriptorSink(STDOUT_FILENO);
+        auto status = std::string("Summarized ") + argv[3] + " in " + std::to_string(sharded.shards) + " shards";
+        if (sharded.skippedTokens > 0)
+            status += ", " + std::to_string(sharded.skippedTokens) + " tokens skipped";
+        // a report on stdout is read by programs, the status goes to stderr then
+        if (format == ReportFormat::Table)
+            out.write(status + "\n");
+        else if (sharded.summary.getCount() == 0)
+            throw UIExcept("No elements in array");
+        else
+            std::cerr << status << std::endl;
+        writeStreamSummary(sharded.summary, L"Values", format.value(), out);
+    }
+    catch (UIExcept& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/// proj1 --save-summary <data file, - for stdin> <summary file>
+/// Saves the summary of the values, which --merge-summaries combines with others.
+int saveSummaryFromArguments(int argc, char** argv)
+{
+    if (argc != 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " --save-summary <data file, - for stdin> <summary file>" << std::endl;
+        return 2;
+    }
+    bool fromStdin = std::string(argv[2]) == "-";
+    int fd = fromStdin ? STDIN_FILENO : ::open(argv[2], O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        std::cerr << "ERROR: Cannot open file" << std::endl;
+        return 1;
+    }
+    try
+    {
+        auto counters = IngestCounters();
+        auto summary = StreamSummary<long>();
+        ingestValues<long>(fd, counters, [&summary](const std::vector<long>& batch)
+        {
+            for (long value : batch)
+                summary.add(value);
+        });
+        if (!fromStdin)
+            ::close(fd);
+        saveSummary(summary, argv[3]);
+    }
+    catch (UIExcept& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/// proj1 --merge-summaries <table|csv|json|binary> [--save <summary file>] <summary file, glob or @list>...
+/// Writes the report of the values of all the summaries, and saves their merged summary when asked.
+int mergeSummariesFromArguments(int argc, char** argv)
+{
+    auto usage = [argv]()
+    {
+        std::cerr << "Usage: " << argv[0] << " --merge-summaries <table|csv|json|binary> [--save <summary file>]"
+                  << " <summary file, glob or @list>..." << std::endl;
+        return 2;
+    };
+    auto format = argc >= 4 ? reportFormatFromName(argv[2]) : std::nullopt;
+    if (!format.has_value())
+        return usage();
+    std::optional<std::string> savePath;
+    std::vector<std::string> arguments;
+    for (int i = 3; i < argc; i++)
+    {
+        if (std::string(argv[i]) != "--save")
+            arguments.emplace_back(argv[i]);
+        else if (i + 1 < argc)
+            savePath = argv[++i];
+        else
+            return usage();
+    }
+
+    try
+    {
+        auto paths = expandFileArguments(arguments);
+        if (paths.empty())
+            return usage();
+        auto merged = mergeSummaryFiles<long>(paths);
+        if (savePath.has_value())
+            saveSummary(merged, savePath.value());
+        if (merged.getCount() == 0)
+            throw UIExcept("No elements in array");
+        auto out = FileDescriptorSink(STDOUT_FILENO);
+        writeStreamSummary(merged, L"Values of " + std::to_wstring(paths.size()) + L" summaries", format.value(), out);
+    }
+    catch (UIExcept& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    // before anything reads std::cin, so prompts and bulk values share one buffer
+    standardInput();
+    if (argc > 1 && std::string(argv[1]) == "--report")
+        return writeReportFromArguments(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "--summarize")
+        return summarizeFilesFromArguments(argc, argv);
+    if (argc > 1 && (std::string(argv[1]) == "--batch" || std::string(argv[1]) == "--script"))
+        return runScriptFromArguments(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "--watch")
+        return watchFromArguments(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "--ingest")
+        return ingestFromArguments(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "--sharded")
+        return shardedFromArguments(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "--save-summary")
+        return saveSummaryFromArguments(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "--merge-summaries")
+        return mergeSummariesFromArguments(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "--serve")
+        return serveFromArguments(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "--query")
+        return queryFromArguments(argc, argv);
+
 //    std::optional<double> op = std::make_optional(54);
 //    std::optional<double> nop = std::nullopt;
 //
@@ -36,5 +521,6 @@ int main()
 
     auto ui = StatsUI();
     ui.run();
+    ui.finishFileWrites();
     return 0;
 }
@@ -0,0 +1,91 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_MOMENTTREE_H
+#define PROJ1_MOMENTTREE_H
+
+#include <vector>
+#include <cassert>
+#include <utility>
+#include "moments.h"
+
+/** Pre-aggregation of a series (in its original order) for range queries.
+ *  The series is cut into blocks of BLOCK_SIZE elements; each block is summarized
+ *  by a Moments accumulator and the blocks form the leaves of a bottom-up segment tree.
+ *  A query over [first, last) merges at most 2 * log(blocks) tree nodes plus
+ *  the elements of the two partial blocks at the ends of the range.
+ *  The tree keeps its own copy of the series, so it takes as much memory as the series
+ *  plus one Moments per block.
+ */
+template <typename T>
+class MomentTree
+{
+public:
+    static constexpr std::size_t BLOCK_SIZE = 64;
+
+    MomentTree() = default;
+
+    explicit MomentTree(std::vector<T> _series)
+        :
+        series {std::move(_series)}
+    {
+        blockCount = (series.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        tree.assign(2 * blockCount, Moments<T>());
+        for (std::size_t i = 0; i < series.size(); i++)
+            tree[blockCount + i / BLOCK_SIZE].add(series[i]);
+        for (std::size_t node = blockCount; node-- > 1; )
+        {
+            tree[node] = tree[2 * node];
+            tree[node].merge(tree[2 * node + 1]);
+        }
+    }
+
+    /// Moments of series[first, last).
+    Moments<T> query(std::size_t first, std::size_t last) const
+    {
+        assert(first <= last && last <= series.size());
+        auto result = Moments<T>();
+
+        std::size_t firstFullBlock = (first + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        std::size_t lastFullBlock = last / BLOCK_SIZE;
+        if (firstFullBlock >= lastFullBlock)
+        {
+            for (std::size_t i = first; i < last; i++)
+                result.add(series[i]);
+            return result;
+        }
+
+        for (std::size_t i = first; i < firstFullBlock * BLOCK_SIZE; i++)
+            result.add(series[i]);
+        for (std::size_t low = firstFullBlock + blockCount, high = lastFullBlock + blockCount;
+             low < high;
+             low /= 2, high /= 2)
+        {
+            if (low & 1) result.merge(tree[low++]);
+            if (high & 1) result.merge(tree[--high]);
+        }
+        for (std::size_t i = lastFullBlock * BLOCK_SIZE; i < last; i++)
+            result.add(series[i]);
+        return result;
+    }
+
+    std::size_t getSize() const { return series.size(); }
+
+    /// The series, in its original order
+    const std::vector<T>& getSeries() const { return series; }
+
+    void clear()
+    {
+        series.clear();
+        tree.clear();
+        blockCount = 0;
+    }
+
+private:
+    std::vector<T> series;
+    std::vector<Moments<T>> tree;
+    std::size_t blockCount = 0;
+};
+
+#endif //PROJ1_MOMENTTREE_H
@@ -0,0 +1,97 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_MOMENTS_H
+#define PROJ1_MOMENTS_H
+
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+/** Mergeable accumulator of count, sum, extrema and the first four central moments.
+ *  Two accumulators built over disjoint parts of a data set merge into the
+ *  accumulator of the whole data set (Chan et al. / Pebay update formulas).
+ */
+template <typename T>
+struct Moments
+{
+    std::size_t count = 0;
+    T sum = 0;
+    T min = std::numeric_limits<T>::max();
+    T max = std::numeric_limits<T>::lowest();
+    double mean = 0.0;
+    double m2 = 0.0;
+    double m3 = 0.0;
+    double m4 = 0.0;
+
+    void add(const T& value)
+    {
+        double n1 = count;
+        count++;
+        double n = count;
+        double delta = value - mean;
+        double deltaN = delta / n;
+        double deltaN2 = deltaN * deltaN;
+        double term1 = delta * deltaN * n1;
+
+        mean += deltaN;
+        m4 += term1 * deltaN2 * (n * n - 3 * n + 3) + 6 * deltaN2 * m2 - 4 * deltaN * m3;
+        m3 += term1 * deltaN * (n - 2) - 3 * deltaN * m2;
+        m2 += term1;
+
+        sum += value;
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    void merge(const Moments& other)
+    {
+        if (other.count == 0)
+            return;
+        if (count == 0)
+        {
+            *this = other;
+            return;
+        }
+
+        double na = count, nb = other.count;
+        double n = na + nb;
+        double delta = other.mean - mean;
+        double delta2 = delta * delta;
+        double delta3 = delta2 * delta;
+        double delta4 = delta2 * delta2;
+
+        double mergedM4 = m4 + other.m4
+                          + delta4 * na * nb * (na * na - na * nb + nb * nb) / (n * n * n)
+                          + 6.0 * delta2 * (na * na * other.m2 + nb * nb * m2) / (n * n)
+                          + 4.0 * delta * (na * other.m3 - nb * m3) / n;
+        double mergedM3 = m3 + other.m3
+                          + delta3 * na * nb * (na - nb) / (n * n)
+                          + 3.0 * delta * (na * other.m2 - nb * m2) / n;
+        double mergedM2 = m2 + other.m2 + delta2 * na * nb / n;
+
+        mean += delta * nb / n;
+        m2 = mergedM2;
+        m3 = mergedM3;
+        m4 = mergedM4;
+        count += other.count;
+        sum += other.sum;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+
+    double getMean() const { return mean; }
+
+    /// Sample variance, same definition as Statistics::getVariance.
+    double getVariance() const
+    {
+        if (count < 2) return 0.0;
+        return m2 / (count - 1);
+    }
+
+    double getStandardDeviation() const { return std::sqrt(getVariance()); }
+};
+
+#endif //PROJ1_MOMENTS_H
@@ -0,0 +1,100 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_PREVIEW_H
+#define PROJ1_PREVIEW_H
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include "histogram.h"
+#include "counterRng.h"
+#include "ui/Utf8.h"
+
+/** What is shown of a data set right after it is loaded. Everything in it is bounded
+ *  by the slice, sample and bin counts, never by the size of the data set.
+ */
+template <typename T>
+struct DataPreview
+{
+    std::size_t count = 0;
+    // first and last values in file order, tail is empty when head holds every value
+    std::vector<T> head;
+    std::vector<T> tail;
+    // values at random positions, in increasing order
+    std::vector<T> sample;
+    T minimum {};
+    T maximum {};
+    Histogram distribution;
+
+    /// Keep the head and tail slices. Must see the values before they are sorted.
+    void captureSlices(const std::vector<T>& inFileOrder, std::size_t sliceLength)
+    {
+        count = inFileOrder.size();
+        if (count <= 2 * sliceLength)
+        {
+            head.assign(inFileOrder.cbegin(), inFileOrder.cend());
+            tail.clear();
+            return;
+        }
+        head.assign(inFileOrder.cbegin(), inFileOrder.cbegin() + sliceLength);
+        tail.assign(inFileOrder.cend() - sliceLength, inFileOrder.cend());
+    }
+
+    /** Draw the sample and the distribution from the sorted values, in
+     *  O(sampleSize^2 + binCount log n) time.
+     */
+    void describeSorted(const std::vector<T>& sorted, std::size_t sampleSize, std::size_t binCount, std::uint64_t seed)
+    {
+        sample.clear();
+        if (sorted.empty())
+            return;
+
+        // Floyd's algorithm: sampleSize distinct positions with one draw each
+        auto rng = CounterRng(seed);
+        std::vector<std::size_t> positions;
+        for (std::size_t j = sorted.size() - std::min(sampleSize, sorted.size()); j < sorted.size(); j++)
+        {
+            auto position = static_cast<std::size_t>(rng.bounded(j + 1));
+            bool taken = std::find(positions.cbegin(), positions.cend(), position) != positions.cend();
+            positions.push_back(taken ? j : position);
+        }
+        std::sort(positions.begin(), positions.end());
+        for (auto position : positions)
+            sample.push_back(sorted[position]);
+        minimum = sorted.front();
+        maximum = sorted.back();
+
+        // integers never need more bins than there are distinct values in the range
+        if constexpr (std::is_integral<T>::value)
+            binCount = static_cast<std::size_t>(std::min<double>(binCount, static_cast<double>(sorted.back()) - sorted.front() + 1));
+        distribution = buildSortedHistogram(sorted.data(), sorted.size(), binCount);
+    }
+};
+
+/// One block character per count, as high as the count relative to the largest one. Empty bins are blank.
+inline std::string sparkline(const std::vector<long>& counts)
+{
+    static const char32_t BLOCKS[] = {U'▁', U'▂', U'▃', U'▄', U'▅', U'▆', U'▇', U'█'};
+    constexpr long LEVELS = sizeof(BLOCKS) / sizeof(BLOCKS[0]);
+
+    long maxCount = counts.empty() ? 0 : *std::max_element(counts.cbegin(), counts.cend());
+    std::string line;
+    for (long count : counts)
+    {
+        if (count == 0)
+            line.push_back(' ');
+        else
+        {
+            // ceil(count * LEVELS / maxCount) - 1, so any non empty bin is visible
+            long level = (count * LEVELS + maxCount - 1) / maxCount - 1;
+            encodeUtf8(BLOCKS[level], std::back_inserter(line));
+        }
+    }
+    return line;
+}
+
+#endif //PROJ1_PREVIEW_H
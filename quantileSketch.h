@@ -0,0 +1,203 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_QUANTILESKETCH_H
+#define PROJ1_QUANTILESKETCH_H
+
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "counterRng.h"
+
+/** Approximate quantiles of a stream in bounded memory (the KLL sketch of Karnin, Lang and
+ *  Liberty). Values are kept in levels; a value of level h stands for 2^h values of the
+ *  stream. When a level is full it is sorted and every other value, starting at a random
+ *  one of the first two, moves up a level, so the sketch keeps O(k log(n / k)) values.
+ *
+ *  The rank error is about 1.7 / k of the count. Until the first level fills up the values
+ *  are all kept and the quantiles are exact.
+ */
+template <typename T>
+class QuantileSketch
+{
+public:
+    /// Sketches of parts of one stream that are merged later should use different streams of rng
+    explicit QuantileSketch(std::size_t _k = 200, std::uint64_t seed = 0, std::uint64_t stream = 0)
+        :
+        k {std::max<std::size_t>(_k, 8)},
+        rng {seed, stream},
+        levels(1)
+    {
+        levelsAdded();
+    }
+
+    /// The sketch whose levels are _levels, as getLevels returned them
+    QuantileSketch(std::size_t _k, std::uint64_t seed, std::vector<std::vector<T>> _levels)
+        :
+        QuantileSketch(_k, seed)
+    {
+        if (!_levels.empty())
+            levels = std::move(_levels);
+        levelsAdded();
+        for (std::size_t level = 0; level < levels.size(); level++)
+            count += levels[level].size() << level;
+    }
+
+    void add(const T& value)
+    {
+        levels[0].push_back(value);
+        count++;
+        if (levels[0].size() >= capacities[0])
+            compress();
+    }
+
+    /** Add the values of other, a sketch of another part of the stream: the levels are put
+     *  together and compacted where they are now full. The rank error stays that of one sketch
+     *  of the whole stream.
+     */
+    void merge(const QuantileSketch& other)
+    {
+        if (other.levels.size() > levels.size())
+        {
+            levels.resize(other.levels.size());
+            levelsAdded();
+        }
+        for (std::size_t level = 0; level < other.levels.size(); level++)
+            levels[level].insert(levels[level].end(), other.levels[level].cbegin(), other.levels[level].cend());
+        count += other.count;
+        compress();
+    }
+
+    /// Values added
+    std::size_t getCount() const
+    {
+        return count;
+    }
+
+    /// Values kept, what the sketch costs
+    std::size_t getRetained() const
+    {
+        std::size_t retained = 0;
+        for (const auto& level : levels)
+            retained += level.size();
+        return retained;
+    }
+
+    std::size_t getK() const
+    {
+        return k;
+    }
+
+    /// The kept values by level, a value of level h standing for 2^h values
+    const std::vector<std::vector<T>>& getLevels() const
+    {
+        return levels;
+    }
+
+    bool isExact() const
+    {
+        return levels.size() == 1;
+    }
+
+    /// Quantile p in [0, 1], interpolated between ranks like Statistics::getQuantile
+    std::optional<double> getQuantile(double p) const
+    {
+        if (count == 0)
+            return std::nullopt;
+        auto ranked = weightedValues();
+        double rank = p * (count - 1);
+        auto below = static_cast<std::size_t>(rank);
+        double fraction = rank - below;
+        double lowValue = valueAtRank(ranked, below);
+        if (fraction == 0.0 || below + 1 >= count)
+            return lowValue;
+        return lowValue + fraction * (valueAtRank(ranked, below + 1) - lowValue);
+    }
+
+private:
+    struct WeightedValue
+    {
+        T value;
+        std::size_t weight;
+    };
+
+    // capacities shrink by this factor for each level below the top
+    static constexpr double LEVEL_DECAY = 2.0 / 3.0;
+
+    std::size_t k;
+    CounterRng rng;
+    std::vector<std::vector<T>> levels;
+    // of each level, they only change with the number of levels
+    std::vector<std::size_t> capacities;
+    std::size_t count = 0;
+
+    void levelsAdded()
+    {
+        capacities.resize(levels.size());
+        for (std::size_t level = 0; level < levels.size(); level++)
+        {
+            std::size_t depth = levels.size() - 1 - level;
+            capacities[level] = std::max<std::size_t>(2, static_cast<std::size_t>(std::ceil(k * std::pow(LEVEL_DECAY, depth))));
+        }
+    }
+
+    /// Compact every level that is full, from the bottom up
+    void compress()
+    {
+        for (std::size_t level = 0; level < levels.size(); level++)
+        {
+            if (levels[level].size() < capacities[level])
+                continue;
+            if (level + 1 == levels.size())
+            {
+                levels.emplace_back();
+                levelsAdded();
+            }
+
+            auto& values = levels[level];
+            std::sort(values.begin(), values.end());
+            // with an odd count the largest value stays, the others pair up
+            std::optional<T> unpaired;
+            if (values.size() % 2 == 1)
+            {
+                unpaired = values.back();
+                values.pop_back();
+            }
+            auto& above = levels[level + 1];
+            for (std::size_t i = rng.bounded(2); i < values.size(); i += 2)
+                above.push_back(values[i]);
+            values.clear();
+            if (unpaired.has_value())
+                values.push_back(unpaired.value());
+        }
+    }
+
+    std::vector<WeightedValue> weightedValues() const
+    {
+        std::vector<WeightedValue> ranked;
+        for (std::size_t level = 0; level < levels.size(); level++)
+            for (const auto& value : levels[level])
+                ranked.push_back(WeightedValue {value, std::size_t {1} << level});
+        std::sort(ranked.begin(), ranked.end(),
+                  [](const WeightedValue& a, const WeightedValue& b) { return a.value < b.value; });
+        return ranked;
+    }
+
+    /// Value of 0-based rank in the stream, each kept value standing for weight ranks
+    double valueAtRank(const std::vector<WeightedValue>& ranked, std::size_t rank) const
+    {
+        std::size_t seen = 0;
+        for (const auto& entry : ranked)
+        {
+            seen += entry.weight;
+            if (rank < seen)
+                return entry.value;
+        }
+        return ranked.back().value;
+    }
+};
+
+#endif //PROJ1_QUANTILESKETCH_H
@@ -0,0 +1,583 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_QUERYSERVER_H
+#define PROJ1_QUERYSERVER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "statistics.h"
+#include "statisticsReport.h"
+#include "reportWriter.h"
+#include "workStealingPool.h"
+#include "snapshot.h"
+#include "ui/OutputSink.h"
+#include "ui/NumberFormat.h"
+#include "ui/UIExcept.h"
+
+/** Datasets of the server by name, each a Versioned Statistics. A reader pins the current version
+ *  of a dataset and answers from it however long it takes, while loads and appends build the
+ *  next version on the side and publish it. Readers never wait for them, and a version is freed
+ *  when the last reader that pinned it is done.
+ */
+class DatasetRegistry
+{
+public:
+    using Dataset = Snapshot<Statistics<long>>;
+
+    /// The current version, throws when no dataset has that name
+    Dataset find(const std::string& name) const
+    {
+        return versionsOf(name).pin();
+    }
+
+    /// Load path as name, replacing the dataset of that name after it was loaded. Returns its size.
+    std::size_t load(const std::string& name, const std::string& path)
+    {
+        auto dataset = std::make_shared<Statistics<long>>();
+        dataset->loadDataFromFilePath(path);
+        if (dataset->getSize() == 0)
+            throw UIExcept("No elements in " + path);
+        dataset->fillCaches();
+        std::size_t size = dataset->getSize();
+        publish(name, std::move(dataset));
+        return size;
+    }
+
+    /// Add the values of path to the dataset name, as a new version. Returns its size.
+    std::size_t append(const std::string& name, const std::string& path)
+    {
+        std::size_t size;
+        versionsOf(name).update([&path, &size](const Dataset& current)
+        {
+            auto next = std::make_shared<Statistics<long>>();
+            next->loadAppendedData(*current, path);
+            next->fillCaches();
+            size = next->getSize();
+            return std::shared_ptr<const Statistics<long>>(std::move(next));
+        });
+        return size;
+    }
+
+    std::vector<std::string> getNames() const
+    {
+        auto current = datasets.pin();
+        std::vector<std::string> names;
+        for (const auto& dataset : *current)
+            names.push_back(dataset.first);
+        return names;
+    }
+
+private:
+    using Datasets = std::map<std::string, std::shared_ptr<Versioned<Statistics<long>>>>;
+
+    // the map is versioned too, it only changes when a name is added
+    Versioned<Datasets> datasets {std::make_shared<const Datasets>()};
+
+    Versioned<Statistics<long>>& versionsOf(const std::string& name) const
+    {
+        auto current = datasets.pin();
+        auto dataset = current->find(name);
+        if (dataset == current->end())
+            throw UIExcept("No dataset " + name);
+        // names are never removed, so the dataset outlives the snapshot of the map
+        return *dataset->second;
+    }
+
+    void publish(const std::string& name, std::shared_ptr<const Statistics<long>> dataset)
+    {
+        auto current = datasets.pin();
+        auto existing = current->find(name);
+        if (existing != current->end())
+        {
+            existing->second->publish(std::move(dataset));
+            return;
+        }
+        // a new name is added with its first version, so no reader finds it empty
+        datasets.update([&name, &dataset](const Snapshot<Datasets>& latest)
+        {
+            auto next = std::make_shared<Datasets>(*latest);
+            auto& versions = (*next)[name];
+            if (versions)
+                versions->publish(std::move(dataset));
+            else
+                versions = std::make_shared<Versioned<Statistics<long>>>(std::move(dataset));
+            return std::shared_ptr<const Datasets>(std::move(next));
+        });
+    }
+};
+
+namespace query_server_detail
+{
+    inline volatile std::sig_atomic_t stopRequested = 0;
+
+    inline void onStop(int)
+    {
+        stopRequested = 1;
+    }
+
+    constexpr int POLL_INTERVAL_MS = 200;
+    // a request line longer than this closes the connection
+    constexpr std::size_t MAX_REQUEST_LENGTH = 4096;
+    // a client that reads none of a reply for this long is dropped, so it holds a worker no longer
+    constexpr int SEND_TIMEOUT_SECONDS = 10;
+
+    inline sockaddr_un socketAddress(const std::string& path)
+    {
+        auto address = sockaddr_un {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+            throw UIExcept("Socket path is too long: " + path);
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return address;
+    }
+
+    inline void sendAll(int fd, std::string_view text)
+    {
+        while (!text.empty())
+        {
+            ssize_t sent = ::send(fd, text.data(), text.size(), MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR)
+                continue;
+            if (sent <= 0)
+                throw UIExcept("Cannot write to client");
+            text.remove_prefix(sent);
+        }
+    }
+
+    /// Sink that appends to a string
+    class StringSink : public OutputSink
+    {
+    public:
+        explicit StringSink(std::string& _text) : text {_text} {}
+
+        void write(std::string_view written) override
+        {
+            text.append(written);
+        }
+
+    private:
+        std::string& text;
+    };
+
+    inline std::string number(double value)
+    {
+        return std::string(FormattedNumber::shortest(value).view());
+    }
+
+    inline std::string number(long long value)
+    {
+        return std::string(FormattedNumber::integer(value).view());
+    }
+}
+
+/** Answers statistics queries about datasets kept in memory, over a Unix domain socket.
+ *
+ *  A request is one line of words, the first the command: "mean prices". A reply is one line,
+ *  "OK <result>" or "ERROR <message>", except the report, "OK <byte count>" followed by that
+ *  many bytes. Commands:
+ *      load <name> <path>          load or reload a dataset, replies with its size
+ *      append <name> <path>        add the values of a file to a dataset, replies with its size
+ *      version <name>              number of the current version of a dataset, 1 for the first load
+ *      list                        names of the datasets
+ *      size|min|max|sum|mean|median|sd|variance <name>
+ *      quantile <name> <p>         p in [0, 1]
+ *      top <name> <k>              the k most frequent values, as value:frequency
+ *      report <name> <table|csv|json|binary>
+ *
+ *  One thread accepts the connections and reads them all. The complete request lines it reads
+ *  are answered by a fixed number of workers, so a connection holds a worker only while its
+ *  requests are answered, never while it is idle. A client may send any number of requests on
+ *  its connection; they are answered one after the other, in order.
+ */
+class QueryServer
+{
+public:
+    QueryServer(std::string _socketPath, std::size_t _workerCount)
+        :
+        socketPath {std::move(_socketPath)},
+        workerCount {std::max<std::size_t>(1, _workerCount)}
+    {}
+
+    DatasetRegistry& getDatasets()
+    {
+        return datasets;
+    }
+
+    /// Reply to one request line, without its line break
+    std::string answer(const std::string& request)
+    {
+        using namespace query_server_detail;
+        auto words = std::istringstream(request);
+        std::string command, name;
+        words >> command >> name;
+        try
+        {
+            if (command == "list")
+            {
+                std::string names;
+                for (const auto& datasetName : datasets.getNames())
+                    names += (names.empty() ? "" : " ") + datasetName;
+                return "OK " + names + "\n";
+            }
+            if (name.empty())
+                throw UIExcept("Missing dataset name");
+            if (command == "load")
+            {
+                std::string path;
+                if (!(words >> path))
+                    throw UIExcept("Missing file path");
+                return "OK " + number(static_cast<long long>(datasets.load(name, path))) + "\n";
+            }
+
+            if (command == "append")
+            {
+                std::string path;
+                if (!(words >> path))
+                    throw UIExcept("Missing file path");
+                return "OK " + number(static_cast<long long>(datasets.append(name, path))) + "\n";
+            }
+
+            // every answer below comes from this one version, whatever is published meanwhile
+            auto dataset = datasets.find(name);
+            if (command == "version") return "OK " + number(static_cast<long long>(dataset.getVersion())) + "\n";
+            if (command == "size") return "OK " + number(static_cast<long long>(dataset->getSize())) + "\n";
+            if (command == "min") return "OK " + number(static_cast<long long>(dataset->getMin())) + "\n";
+            if (command == "max") return "OK " + number(static_cast<long long>(dataset->getMax())) + "\n";
+            if (command == "sum") return "OK " + number(static_cast<long long>(dataset->getSum())) + "\n";
+            if (command == "mean") return "OK " + number(dataset->getMean()) + "\n";
+            if (command == "median") return "OK " + number(dataset->getQuantile(0.5)) + "\n";
+            if (command == "sd") return "OK " + number(dataset->getStandardDeviation()) + "\n";
+            if (command == "variance") return "OK " + number(dataset->getVariance()) + "\n";
+            if (command == "quantile")
+            {
+                double p;
+                if (!(words >> p) || p < 0 || p > 1)
+                    throw UIExcept("Quantile must be between 0 and 1");
+                return "OK " + number(dataset->getQuantile(p)) + "\n";
+            }
+            if (command == "top")
+            {
+                long count;
+                if (!(words >> count) || count <= 0)
+                    throw UIExcept("Count must be positive");
+                std::string reply = "OK";
+                for (const auto& entry : dataset->getMostFrequent(count))
+                    reply += " " + number(static_cast<long long>(entry.value)) + ":"
+                             + number(static_cast<long long>(entry.frequency));
+                return reply + "\n";
+            }
+            if (command == "report")
+            {
+                std::string formatName;
+                words >> formatName;
+                auto format = reportFormatFromName(formatName);
+                if (!format.has_value())
+                    throw UIExcept("Report format must be table, csv, json or binary");
+                auto reply = std::string();
+                auto replySink = StringSink(reply);
+                StatisticsReport(*dataset).write(format.value(), replySink);
+                return "OK " + number(static_cast<long long>(reply.size())) + "\n" + reply;
+            }
+            throw UIExcept("Unknown command " + command);
+        }
+        catch (UIExcept& e)
+        {
+            return std::string("ERROR ") + e.what() + "\n";
+        }
+        catch (std::bad_alloc&)
+        {
+            return "ERROR Out of memory\n";
+        }
+        catch (std::exception& e)
+        {
+            // answers run on pool tasks, which must not throw
+            return std::string("ERROR ") + e.what() + "\n";
+        }
+    }
+
+    /** Listen on the socket until SIGINT or SIGTERM, then stop accepting, close the open
+     *  connections and remove the socket.
+     */
+    void run()
+    {
+        using namespace query_server_detail;
+        int listener = openListener();
+        int wakeFds[2];
+        if (::pipe2(wakeFds, O_CLOEXEC | O_NONBLOCK) != 0)
+        {
+            ::close(listener);
+            throw UIExcept("Cannot create pipe");
+        }
+        wakeReader = wakeFds[0];
+        wakeWriter = wakeFds[1];
+
+        struct sigaction stopAction {}, previousInterrupt {}, previousTerminate {};
+        stopAction.sa_handler = onStop;
+        sigemptyset(&stopAction.sa_mask);
+        stopRequested = 0;
+        ::sigaction(SIGINT, &stopAction, &previousInterrupt);
+        ::sigaction(SIGTERM, &stopAction, &previousTerminate);
+
+        {
+            auto workers = WorkStealingPool(workerCount);
+            std::vector<pollfd> watched;
+            while (!stopRequested)
+            {
+                // a connection whose requests are being answered is read again once they are
+                watched.assign({pollfd {listener, POLLIN, 0}, pollfd {wakeReader, POLLIN, 0}});
+                for (const auto& [client, connection] : connections)
+                    if (!connection.busy)
+                        watched.push_back(pollfd {client, POLLIN, 0});
+                if (::poll(watched.data(), watched.size(), POLL_INTERVAL_MS) <= 0)
+                    continue;
+
+                if (watched[1].revents != 0)
+                    takeAnswered(workers);
+                for (auto watchedClient = watched.begin() + 2; watchedClient != watched.end(); watchedClient++)
+                    if (watchedClient->revents != 0)
+                        receive(watchedClient->fd, workers);
+                if (watched[0].revents != 0)
+                    accept(listener);
+            }
+
+            // a worker still sending a reply fails at once, the pool then ends with its tasks
+            for (const auto& connection : connections)
+                ::shutdown(connection.first, SHUT_RDWR);
+        }
+
+        for (const auto& connection : connections)
+            ::close(connection.first);
+        connections.clear();
+        answered.clear();
+        ::close(wakeReader);
+        ::close(wakeWriter);
+        ::close(listener);
+        ::unlink(socketPath.c_str());
+        ::sigaction(SIGINT, &previousInterrupt, nullptr);
+        ::sigaction(SIGTERM, &previousTerminate, nullptr);
+    }
+
+private:
+    /// A client, known only to the thread that runs the server
+    struct Connection
+    {
+        // received after the last complete request line
+        std::string pending;
+        // its requests are with a worker
+        bool busy = false;
+        // the client sent all its requests, it is closed once they are answered
+        bool closing = false;
+    };
+
+    /// Requests of client answered by a worker, false when the client could not be written to
+    struct Answered
+    {
+        int client;
+        bool sent;
+    };
+
+    std::string socketPath;
+    std::size_t workerCount;
+    DatasetRegistry datasets;
+
+    std::map<int, Connection> connections;
+    // a worker that answered the requests of a connection tells the server thread through the pipe
+    std::mutex answeredMutex;
+    std::vector<Answered> answered;
+    int wakeReader = -1;
+    int wakeWriter = -1;
+
+    int openListener()
+    {
+        using namespace query_server_detail;
+        auto address = socketAddress(socketPath);
+        int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listener < 0)
+            throw UIExcept("Cannot create socket");
+
+        // a socket left behind by a server that is gone is replaced, a live one is not
+        int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool inUse = probe >= 0 && ::connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        if (probe >= 0)
+            ::close(probe);
+        if (inUse)
+        {
+            ::close(listener);
+            throw UIExcept("A server is already listening on " + socketPath);
+        }
+        ::unlink(socketPath.c_str());
+
+        if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || ::listen(listener, SOMAXCONN) != 0)
+        {
+            ::close(listener);
+            throw UIExcept("Cannot listen on " + socketPath);
+        }
+        return listener;
+    }
+
+    void accept(int listener)
+    {
+        using namespace query_server_detail;
+        int client = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0)
+            return;
+        auto timeout = timeval {SEND_TIMEOUT_SECONDS, 0};
+        ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        connections[client] = Connection();
+    }
+
+    /// Read what client sent, and hand the requests it completes to a worker
+    void receive(int client, WorkStealingPool& workers)
+    {
+        auto& connection = connections.at(client);
+        char received[4096];
+        ssize_t count = ::recv(client, received, sizeof(received), MSG_DONTWAIT);
+        if (count > 0)
+            connection.pending.append(received, count);
+        else if (count == 0 || (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK))
+            connection.closing = true;
+        dispatch(client, connection, workers);
+    }
+
+    void dispatch(int client, Connection& connection, WorkStealingPool& workers)
+    {
+        using namespace query_server_detail;
+        std::vector<std::string> requests;
+        std::size_t lineStart = 0, lineEnd;
+        while ((lineEnd = connection.pending.find('\n', lineStart)) != std::string::npos)
+        {
+            auto request = connection.pending.substr(lineStart, lineEnd - lineStart);
+            if (!request.empty() && request.back() == '\r')
+                request.pop_back();
+            requests.push_back(std::move(request));
+            lineStart = lineEnd + 1;
+        }
+        connection.pending.erase(0, lineStart);
+
+        if (!requests.empty())
+        {
+            connection.busy = true;
+            workers.submit([this, client, requests = std::move(requests)]
+            {
+                bool sent = true;
+                try
+                {
+                    for (const auto& request : requests)
+                        sendAll(client, answer(request));
+                }
+                catch (UIExcept&)
+                {
+                    // the client is gone, or does not read its replies
+                    sent = false;
+                }
+                {
+                    auto lock = std::lock_guard<std::mutex>(answeredMutex);
+                    answered.push_back(Answered {client, sent});
+                }
+                char wake = 1;
+                [[maybe_unused]] auto written = ::write(wakeWriter, &wake, 1);
+            });
+            return;
+        }
+        if (connection.pending.size() > MAX_REQUEST_LENGTH)
+        {
+            try
+            {
+                sendAll(client, "ERROR Request is too long\n");
+            }
+            catch (UIExcept&)
+            {
+            }
+            connection.closing = true;
+        }
+        if (connection.closing)
+            close(client);
+    }
+
+    /// Go on with the connections whose requests the workers answered
+    void takeAnswered(WorkStealingPool& workers)
+    {
+        char wakes[64];
+        while (::read(wakeReader, wakes, sizeof(wakes)) > 0)
+            ;
+        std::vector<Answered> done;
+        {
+            auto lock = std::lock_guard<std::mutex>(answeredMutex);
+            done.swap(answered);
+        }
+        for (const auto& [client, sent] : done)
+        {
+            auto& connection = connections.at(client);
+            connection.busy = false;
+            if (!sent)
+                close(client);
+            else
+                dispatch(client, connection, workers);
+        }
+    }
+
+    void close(int client)
+    {
+        connections.erase(client);
+        ::close(client);
+    }
+};
+
+/** Send request to the server listening on socketPath and return the reply, the report
+ *  included. Throws when the server cannot be reached.
+ */
+inline std::string queryServer(const std::string& socketPath, const std::string& request)
+{
+    using namespace query_server_detail;
+    auto address = socketAddress(socketPath);
+    int server = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (server < 0 || ::connect(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        if (server >= 0)
+            ::close(server);
+        throw UIExcept("Cannot connect to " + socketPath);
+    }
+
+    std::string reply;
+    try
+    {
+        sendAll(server, request + "\n");
+        // everything up to the first line break, and the report that may follow it
+        ::shutdown(server, SHUT_WR);
+        char received[4096];
+        ssize_t count;
+        while ((count = ::recv(server, received, sizeof(received), 0)) != 0)
+        {
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count < 0)
+                throw UIExcept("Cannot read from " + socketPath);
+            reply.append(received, count);
+        }
+    }
+    catch (UIExcept&)
+    {
+        ::close(server);
+        throw;
+    }
+    ::close(server);
+    return reply;
+}
+
+#endif //PROJ1_QUERYSERVER_H
@@ -0,0 +1,346 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_REPORTWRITER_H
+#define PROJ1_REPORTWRITER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <memory>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "ui/RenderBuffer.h"
+#include "ui/OutputSink.h"
+#include "ui/NumberFormat.h"
+
+enum class ReportFormat
+{
+    Table,
+    Csv,
+    JsonLines,
+    Binary
+};
+
+/// Format selected by its menu letter: T, C, J or B
+inline std::optional<ReportFormat> reportFormatFromLetter(char letter)
+{
+    switch (tolower(letter))
+    {
+        case 't': return ReportFormat::Table;
+        case 'c': return ReportFormat::Csv;
+        case 'j': return ReportFormat::JsonLines;
+        case 'b': return ReportFormat::Binary;
+        default: return std::nullopt;
+    }
+}
+
+/// Format selected by name: table, csv, json or binary
+inline std::optional<ReportFormat> reportFormatFromName(std::string_view name)
+{
+    if (name == "table") return ReportFormat::Table;
+    if (name == "csv") return ReportFormat::Csv;
+    if (name == "json") return ReportFormat::JsonLines;
+    if (name == "binary") return ReportFormat::Binary;
+    return std::nullopt;
+}
+
+/** Machine readable report. Statistics are written as they are passed in, nothing
+ *  is collected first, so the frequency table can be written one entry at a time.
+ *  Names are lower case identifiers such as "standard_deviation".
+ */
+class ReportWriter
+{
+public:
+    explicit ReportWriter(OutputSink& _sink)
+        :
+        sink {_sink},
+        buffer {_sink}
+    {}
+
+    virtual ~ReportWriter() = default;
+
+    virtual void writeInteger(std::string_view name, long long value) = 0;
+    virtual void writeReal(std::string_view name, double value) = 0;
+    /// Statistic without a value, such as the median of too few elements
+    virtual void writeMissing(std::string_view name) = 0;
+    virtual void writeIntegers(std::string_view name, const std::vector<long>& values) = 0;
+    /// One entry of the frequency table, percentage is in [0, 100]
+    virtual void writeFrequency(long value, long frequency, double percentage) = 0;
+
+    void writeReal(std::string_view name, const std::optional<double>& value)
+    {
+        if (value.has_value())
+            writeReal(name, value.value());
+        else
+            writeMissing(name);
+    }
+
+    /// Write everything that is still buffered
+    virtual void finish()
+    {
+        buffer.flush();
+        sink.flush();
+    }
+
+protected:
+    OutputSink& sink;
+    RenderBuffer buffer;
+};
+
+/** One row per value with the columns statistic,value,frequency,percentage.
+ *  Lists take one row per element, missing values and empty lists an empty value,
+ *  and only the rows of the frequency table fill the last two columns.
+ */
+class CsvReportWriter : public ReportWriter
+{
+public:
+    explicit CsvReportWriter(OutputSink& _sink) : ReportWriter(_sink)
+    {
+        buffer.append("statistic,value,frequency,percentage\n");
+    }
+
+    void writeInteger(std::string_view name, long long value) override
+    {
+        row(name, FormattedNumber::integer(value).view());
+    }
+
+    void writeReal(std::string_view name, double value) override
+    {
+        row(name, FormattedNumber::shortest(value).view());
+    }
+
+    void writeMissing(std::string_view name) override
+    {
+        row(name, "");
+    }
+
+    void writeIntegers(std::string_view name, const std::vector<long>& values) override
+    {
+        if (values.empty())
+            writeMissing(name);
+        for (long value : values)
+            writeInteger(name, value);
+    }
+
+    void writeFrequency(long value, long frequency, double percentage) override
+    {
+        buffer.append("frequency,");
+        buffer.append(FormattedNumber::integer(value));
+        buffer.append(',');
+        buffer.append(FormattedNumber::integer(frequency));
+        buffer.append(',');
+        buffer.append(FormattedNumber::shortest(percentage));
+        buffer.append('\n');
+    }
+
+private:
+    void row(std::string_view name, std::string_view value)
+    {
+        buffer.append(name);
+        buffer.append(',');
+        buffer.append(value);
+        buffer.append(",,\n");
+    }
+};
+
+/** One JSON object per line, {"statistic":name,"value":number}. Missing and non finite
+ *  values are null, lists are written as "values":[...] and the frequency table adds
+ *  "frequency" and "percentage" to the value.
+ */
+class JsonLinesReportWriter : public ReportWriter
+{
+public:
+    using ReportWriter::ReportWriter;
+
+    void writeInteger(std::string_view name, long long value) override
+    {
+        beginObject(name);
+        buffer.append(",\"value\":");
+        buffer.append(FormattedNumber::integer(value));
+        endObject();
+    }
+
+    void writeReal(std::string_view name, double value) override
+    {
+        beginObject(name);
+        buffer.append(",\"value\":");
+        appendReal(value);
+        endObject();
+    }
+
+    void writeMissing(std::string_view name) override
+    {
+        beginObject(name);
+        buffer.append(",\"value\":null");
+        endObject();
+    }
+
+    void writeIntegers(std::string_view name, const std::vector<long>& values) override
+    {
+        beginObject(name);
+        buffer.append(",\"values\":[");
+        for (std::size_t i = 0; i < values.size(); i++)
+        {
+            if (i != 0)
+                buffer.append(',');
+            buffer.append(FormattedNumber::integer(values[i]));
+        }
+        buffer.append(']');
+        endObject();
+    }
+
+    void writeFrequency(long value, long frequency, double percentage) override
+    {
+        beginObject("frequency");
+        buffer.append(",\"value\":");
+        buffer.append(FormattedNumber::integer(value));
+        buffer.append(",\"frequency\":");
+        buffer.append(FormattedNumber::integer(frequency));
+        buffer.append(",\"percentage\":");
+        appendReal(percentage);
+        endObject();
+    }
+
+private:
+    // names are identifiers, they never need escaping
+    void beginObject(std::string_view name)
+    {
+        buffer.append("{\"statistic\":\"");
+        buffer.append(name);
+        buffer.append('"');
+    }
+
+    void endObject()
+    {
+        buffer.append("}\n");
+    }
+
+    void appendReal(double value)
+    {
+        if (std::isfinite(value))
+            buffer.append(FormattedNumber::shortest(value));
+        else
+            buffer.append("null");
+    }
+};
+
+/** Compact binary records, all numbers little endian.
+ *
+ *  The report starts with the 4 bytes "STAT" and a version byte (1). Every record is a kind
+ *  byte, a name length byte, the name and a payload that depends on the kind:
+ *      1 integer       int64
+ *      2 real          IEEE 754 binary64
+ *      3 missing       nothing
+ *      4 integers      uint64 count, then count int64
+ *      5 frequency     int64 value, int64 frequency, binary64 percentage
+ *  The report ends with a record of kind 0 and an empty name.
+ */
+class BinaryReportWriter : public ReportWriter
+{
+public:
+    static constexpr std::uint8_t VERSION = 1;
+
+    enum RecordKind : std::uint8_t
+    {
+        End = 0,
+        Integer = 1,
+        Real = 2,
+        Missing = 3,
+        Integers = 4,
+        Frequency = 5
+    };
+
+    explicit BinaryReportWriter(OutputSink& _sink) : ReportWriter(_sink)
+    {
+        buffer.append("STAT");
+        buffer.append(static_cast<char>(VERSION));
+    }
+
+    void writeInteger(std::string_view name, long long value) override
+    {
+        beginRecord(Integer, name);
+        appendInt64(value);
+    }
+
+    void writeReal(std::string_view name, double value) override
+    {
+        beginRecord(Real, name);
+        appendReal(value);
+    }
+
+    void writeMissing(std::string_view name) override
+    {
+        beginRecord(Missing, name);
+    }
+
+    void writeIntegers(std::string_view name, const std::vector<long>& values) override
+    {
+        beginRecord(Integers, name);
+        appendUint64(values.size());
+        for (long value : values)
+            appendInt64(value);
+    }
+
+    void writeFrequency(long value, long frequency, double percentage) override
+    {
+        beginRecord(Frequency, "frequency");
+        appendInt64(value);
+        appendInt64(frequency);
+        appendReal(percentage);
+    }
+
+    void finish() override
+    {
+        beginRecord(End, "");
+        ReportWriter::finish();
+    }
+
+private:
+    void beginRecord(RecordKind kind, std::string_view name)
+    {
+        buffer.append(static_cast<char>(kind));
+        buffer.append(static_cast<char>(name.size()));
+        buffer.append(name);
+    }
+
+    void appendUint64(std::uint64_t value)
+    {
+        char bytes[8];
+        for (char& byte : bytes)
+        {
+            byte = static_cast<char>(value & 0xFF);
+            value >>= 8;
+        }
+        buffer.append(std::string_view(bytes, sizeof(bytes)));
+    }
+
+    void appendInt64(std::int64_t value)
+    {
+        appendUint64(static_cast<std::uint64_t>(value));
+    }
+
+    void appendReal(double value)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        appendUint64(bits);
+    }
+};
+
+/// Writer for a machine readable format, nullptr for ReportFormat::Table
+inline std::unique_ptr<ReportWriter> makeReportWriter(ReportFormat format, OutputSink& sink)
+{
+    switch (format)
+    {
+        case ReportFormat::Csv: return std::make_unique<CsvReportWriter>(sink);
+        case ReportFormat::JsonLines: return std::make_unique<JsonLinesReportWriter>(sink);
+        case ReportFormat::Binary: return std::make_unique<BinaryReportWriter>(sink);
+        default: return nullptr;
+    }
+}
+
+#endif //PROJ1_REPORTWRITER_H
@@ -0,0 +1,229 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_ROLLINGSTATISTICS_H
+#define PROJ1_ROLLINGSTATISTICS_H
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <optional>
+#include <cmath>
+#include <functional>
+#include <cassert>
+
+/** Tracks one quantile of a multiset that supports insertion and removal.
+ *  Elements are split between two ordered heaps (`low` and `high`) so that
+ *  `low` always holds the elements up to and including the quantile position.
+ *  Both insertion and removal are O(log N).
+ */
+template <typename T>
+class QuantileTracker
+{
+public:
+    explicit QuantileTracker(double _probability)
+        :
+        probability {_probability}
+    {
+        assert(probability >= 0.0 && probability <= 1.0);
+    }
+
+    void insert(const T& value)
+    {
+        if (!low.empty() && value <= *low.rbegin())
+            low.insert(value);
+        else
+            high.insert(value);
+        rebalance();
+    }
+
+    void erase(const T& value)
+    {
+        if (!low.empty() && value <= *low.rbegin())
+            low.erase(low.find(value));
+        else
+            high.erase(high.find(value));
+        rebalance();
+    }
+
+    /// Quantile with linear interpolation between the two closest ranks.
+    std::optional<double> getValue() const
+    {
+        if (low.empty())
+            return std::nullopt;
+
+        double rank = probability * (getSize() - 1);
+        double fraction = rank - std::floor(rank);
+        double lowValue = *low.rbegin();
+        if (fraction == 0.0 || high.empty())
+            return lowValue;
+        return lowValue + fraction * (*high.begin() - lowValue);
+    }
+
+    double getProbability() const { return probability; }
+
+    std::size_t getSize() const { return low.size() + high.size(); }
+
+private:
+    double probability;
+    std::multiset<T> low, high;
+
+    void rebalance()
+    {
+        std::size_t target = getSize() == 0
+                             ? 0
+                             : static_cast<std::size_t>(std::floor(probability * (getSize() - 1))) + 1;
+        while (low.size() > target)
+        {
+            auto largestLow = std::prev(low.end());
+            high.insert(*largestLow);
+            low.erase(largestLow);
+        }
+        while (low.size() < target)
+        {
+            low.insert(*high.begin());
+            high.erase(high.begin());
+        }
+    }
+};
+
+/** Statistics over a sliding window of the last N samples.
+ *  Mean and variance are updated in O(1) per sample (Welford's update and its inverse),
+ *  median and quantiles in O(log N) per sample.
+ */
+template <typename T>
+class RollingStatistics
+{
+public:
+    struct Step
+    {
+        std::size_t index;
+        T value;
+        std::size_t windowSize;
+        double mean;
+        double variance;
+        std::optional<double> median;
+        std::vector<std::optional<double>> quantiles;
+    };
+
+    explicit RollingStatistics(std::size_t _windowCapacity,
+                               const std::vector<double>& quantileProbabilities = {0.25, 0.75})
+        :
+        windowCapacity {_windowCapacity},
+        window (_windowCapacity),
+        medianTracker {0.5}
+    {
+        assert(windowCapacity > 0);
+        for (double probability : quantileProbabilities)
+            quantileTrackers.emplace_back(probability);
+    }
+
+    void push(const T& value)
+    {
+        if (windowSize == windowCapacity)
+        {
+            const T& evicted = window[head];
+            removeFromMoments(evicted);
+            medianTracker.erase(evicted);
+            for (auto& tracker : quantileTrackers)
+                tracker.erase(evicted);
+        }
+        else
+            windowSize++;
+
+        window[head] = value;
+        head = (head + 1) % windowCapacity;
+        addToMoments(value);
+        medianTracker.insert(value);
+        for (auto& tracker : quantileTrackers)
+            tracker.insert(value);
+        pushedCount++;
+    }
+
+    double getMean() const { return mean; }
+
+    double getVariance() const
+    {
+        if (windowSize < 2) return 0.0;
+        return m2 / (windowSize - 1);
+    }
+
+    double getStandardDeviation() const { return std::sqrt(getVariance()); }
+
+    std::optional<double> getMedian() const { return medianTracker.getValue(); }
+
+    std::optional<double> getQuantile(std::size_t trackerIndex) const
+    {
+        return quantileTrackers.at(trackerIndex).getValue();
+    }
+
+    std::size_t getWindowSize() const { return windowSize; }
+
+    Step getStep(const T& lastValue) const
+    {
+        auto step = Step {pushedCount - 1, lastValue, windowSize, getMean(), getVariance(), getMedian(), {}};
+        for (const auto& tracker : quantileTrackers)
+            step.quantiles.push_back(tracker.getValue());
+        return step;
+    }
+
+    /// Push every element of [begin, end) and report the window state after each one.
+    template <typename InputIt, typename StepCallback>
+    void runOver(InputIt begin, InputIt end, StepCallback onStep)
+    {
+        for (; begin != end; ++begin)
+        {
+            push(*begin);
+            onStep(getStep(*begin));
+        }
+    }
+
+    /// Same as above but for a stream of whitespace separated values.
+    template <typename StepCallback>
+    void runOver(std::istream& is, StepCallback onStep)
+    {
+        T value;
+        while (is >> value)
+        {
+            push(value);
+            onStep(getStep(value));
+        }
+    }
+
+private:
+    std::size_t windowCapacity;
+    std::vector<T> window;
+    std::size_t head = 0;
+    std::size_t windowSize = 0;
+    std::size_t pushedCount = 0;
+
+    double mean = 0.0;
+    double m2 = 0.0;
+
+    QuantileTracker<T> medianTracker;
+    std::vector<QuantileTracker<T>> quantileTrackers;
+
+    void addToMoments(const T& value)
+    {
+        double delta = value - mean;
+        mean += delta / windowSize;
+        m2 += delta * (value - mean);
+    }
+
+    void removeFromMoments(const T& value)
+    {
+        if (windowSize == 1)
+        {
+            mean = 0.0;
+            m2 = 0.0;
+            return;
+        }
+        double delta = value - mean;
+        mean -= delta / (windowSize - 1);
+        m2 -= delta * (value - mean);
+        if (m2 < 0.0) m2 = 0.0;
+    }
+};
+
+#endif //PROJ1_ROLLINGSTATISTICS_H
@@ -0,0 +1,316 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_SAMPLING_H
+#define PROJ1_SAMPLING_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <numeric>
+#include <charconv>
+#include <cmath>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "statistics.h"
+#include "moments.h"
+#include "bootstrap.h"
+#include "counterRng.h"
+#include "ui/UIExcept.h"
+
+using SamplingDeadline = std::optional<std::chrono::steady_clock::time_point>;
+
+/// Inverse of the standard normal CDF (Acklam's rational approximation, relative error < 1.2e-9).
+inline double normalQuantile(double p)
+{
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                               1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                               6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                               3.754408661907416e+00};
+    const double low = 0.02425;
+    if (p < low)
+    {
+        double q = std::sqrt(-2 * std::log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+    if (p > 1 - low)
+        return -normalQuantile(1 - p);
+    double q = p - 0.5, r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+/** Samples whole blocks of a memory-mapped file in random order, without replacement.
+ *  A value belongs to the block its first character is in, so once every block has been
+ *  sampled the sample is exactly the content of the file.
+ */
+template <typename T>
+class BlockSampler
+{
+public:
+    static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+    BlockSampler(const std::string& path, std::uint64_t seed)
+    {
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw UIExcept("Cannot open file");
+        struct stat fileStat {};
+        if (::fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            ::close(fd);
+            throw UIExcept("Cannot sample an empty file");
+        }
+        fileSize = fileStat.st_size;
+        void* mapped = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED)
+        {
+            ::close(fd);
+            throw UIExcept("Cannot map file");
+        }
+        data = static_cast<const char*>(mapped);
+
+        blockOrder.resize((fileSize + BLOCK_SIZE - 1) / BLOCK_SIZE);
+        std::iota(blockOrder.begin(), blockOrder.end(), 0);
+        auto rng = CounterRng(seed);
+        for (std::size_t i = blockOrder.size() - 1; i > 0; i--)
+            std::swap(blockOrder[i], blockOrder[rng.bounded(i + 1)]);
+    }
+
+    BlockSampler(const BlockSampler&) = delete;
+    BlockSampler& operator=(const BlockSampler&) = delete;
+
+    ~BlockSampler()
+    {
+        ::munmap(const_cast<char*>(data), fileSize);
+        ::close(fd);
+    }
+
+    /// Add blocks to the sample until it holds targetSize values, the deadline passes or the file is exhausted.
+    void sampleInto(std::vector<T>& sample, std::size_t targetSize, SamplingDeadline deadline)
+    {
+        while (!isExhausted() && sample.size() < targetSize)
+        {
+            if (deadline.has_value() && std::chrono::steady_clock::now() >= deadline.value())
+                break;
+            std::size_t block = blockOrder[nextBlock++];
+            auto blockMoments = parseBlock(block, sample);
+            sampledBlocks.push_back(SampledBlock {static_cast<double>(std::min(BLOCK_SIZE, fileSize - block * BLOCK_SIZE)),
+                                                  static_cast<double>(blockMoments.count),
+                                                  static_cast<double>(blockMoments.sum)});
+        }
+    }
+
+    bool isExhausted() const { return nextBlock == blockOrder.size(); }
+
+    double getCoverage() const { return static_cast<double>(nextBlock) / blockOrder.size(); }
+
+    /// Estimated number of values in the whole file.
+    ConfidenceInterval estimateCount(double level) const { return estimateTotal(&SampledBlock::count, level); }
+
+    /// Estimated sum of the values in the whole file.
+    ConfidenceInterval estimateSum(double level) const { return estimateTotal(&SampledBlock::sum, level); }
+
+private:
+    int fd = -1;
+    const char* data = nullptr;
+    std::size_t fileSize = 0;
+    std::vector<std::size_t> blockOrder;
+    std::size_t nextBlock = 0;
+
+    struct SampledBlock
+    {
+        double bytes;
+        double count;
+        double sum;
+    };
+    // basis of the population estimates
+    std::vector<SampledBlock> sampledBlocks;
+
+    static bool isSpace(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    Moments<T> parseBlock(std::size_t block, std::vector<T>& sample) const
+    {
+        auto moments = Moments<T>();
+        const char* end = data + fileSize;
+        const char* position = data + block * BLOCK_SIZE;
+        const char* blockEnd = std::min(end, position + BLOCK_SIZE);
+        // a value cut by the start of the block belongs to the previous block
+        if (position != data && !isSpace(position[-1]))
+            while (position < blockEnd && !isSpace(*position))
+                position++;
+
+        while (true)
+        {
+            while (position < blockEnd && isSpace(*position))
+                position++;
+            if (position >= blockEnd)
+                break;
+            const char* tokenEnd = position;
+            while (tokenEnd < end && !isSpace(*tokenEnd))
+                tokenEnd++;
+            T value;
+            if (std::from_chars(position, tokenEnd, value).ec == std::errc())
+            {
+                sample.push_back(value);
+                moments.add(value);
+            }
+            position = tokenEnd;
+        }
+        return moments;
+    }
+
+    /** Ratio estimator of a file total: (total per sampled byte) * file size, with a normal
+     *  interval and finite population correction. Exact once every block is sampled.
+     */
+    ConfidenceInterval estimateTotal(double SampledBlock::* total, double level) const
+    {
+        double sampledBytes = 0.0, sampledTotal = 0.0;
+        for (const auto& block : sampledBlocks)
+        {
+            sampledBytes += block.bytes;
+            sampledTotal += block.*total;
+        }
+        double ratio = sampledBytes > 0 ? sampledTotal / sampledBytes : 0.0;
+        double estimate = ratio * fileSize;
+
+        double n = sampledBlocks.size(), blockCount = blockOrder.size();
+        double residualSquares = 0.0;
+        for (const auto& block : sampledBlocks)
+        {
+            double residual = block.*total - ratio * block.bytes;
+            residualSquares += residual * residual;
+        }
+        double standardError = n > 1
+                               ? blockCount * std::sqrt((1.0 - n / blockCount) * residualSquares / (n - 1) / n)
+                               : 0.0;
+        double z = normalQuantile(0.5 + level / 2.0);
+        return ConfidenceInterval {estimate, estimate - z * standardError, estimate + z * standardError};
+    }
+};
+
+/** Uniform sample of sampleSize values from a stream (Vitter's Algorithm L), in one pass.
+ *  The moments of every value read, not only the sampled ones, are accumulated into population.
+ */
+template <typename T>
+void reservoirSample(std::istream& is, std::size_t sampleSize, CounterRng& rng,
+                     std::vector<T>& sample, Moments<T>& population)
+{
+    sample.clear();
+    T value;
+    while (sample.size() < sampleSize && is >> value)
+    {
+        sample.push_back(value);
+        population.add(value);
+    }
+    if (sample.size() < sampleSize)
+        return;
+
+    auto randomLog = [&rng]() { return std::log(1.0 - rng.uniform()); };
+    double w = std::exp(randomLog() / sampleSize);
+    while (true)
+    {
+        auto skip = static_cast<std::size_t>(std::floor(randomLog() / std::log(1.0 - w)));
+        for (std::size_t i = 0; i < skip; i++)
+        {
+            if (!(is >> value))
+                return;
+            population.add(value);
+        }
+        if (!(is >> value))
+            return;
+        population.add(value);
+        sample[rng.bounded(sampleSize)] = value;
+        w *= std::exp(randomLog() / sampleSize);
+    }
+}
+
+/** Statistics over a resample (with replacement) of a sorted sample. The counts of each
+ *  sample index are drawn first, so the resample comes out sorted without a sort. Buffers
+ *  are reused between resamples.
+ */
+template <typename T>
+class ResampledStatistics : public Statistics<T>
+{
+public:
+    void resampleFrom(const std::vector<T>& sortedSample, CounterRng& rng)
+    {
+        this->clear();
+        counts.assign(sortedSample.size(), 0);
+        for (std::size_t d = 0; d < sortedSample.size(); d++)
+            counts[rng.bounded(sortedSample.size())]++;
+        for (std::size_t i = 0; i < sortedSample.size(); i++)
+            this->elements.insert(this->elements.end(), counts[i], sortedSample[i]);
+    }
+
+private:
+    std::vector<std::uint32_t> counts;
+};
+
+template <typename T>
+using SampleMetric = std::function<double(const Statistics<T>&)>;
+
+/** Percentile bootstrap intervals for arbitrary metrics of a sorted sample. All metrics
+ *  are evaluated on the same resamples. A metric may return NaN when it is undefined.
+ */
+template <typename T>
+std::vector<ConfidenceInterval> bootstrapMetricIntervals(const std::vector<T>& sortedSample,
+                                                         const std::vector<SampleMetric<T>>& metrics,
+                                                         std::size_t resampleCount,
+                                                         double confidenceLevel,
+                                                         std::uint64_t seed)
+{
+    std::vector<std::vector<double>> values(metrics.size(), std::vector<double>(resampleCount));
+    std::size_t threadCount = std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(),
+                                                                             resampleCount));
+    auto work = [&](std::size_t firstResample, std::size_t lastResample)
+    {
+        auto resampled = ResampledStatistics<T>();
+        for (std::size_t r = firstResample; r < lastResample; r++)
+        {
+            auto rng = CounterRng(seed, r);
+            resampled.resampleFrom(sortedSample, rng);
+            for (std::size_t m = 0; m < metrics.size(); m++)
+                values[m][r] = metrics[m](resampled);
+        }
+    };
+    std::size_t perThread = (resampleCount + threadCount - 1) / threadCount;
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < threadCount; t++)
+        workers.emplace_back(work, std::min(resampleCount, t * perThread),
+                             std::min(resampleCount, (t + 1) * perThread));
+    work(0, std::min(resampleCount, perThread));
+    for (auto& worker : workers)
+        worker.join();
+
+    auto sampleStatistics = Statistics<T>(std::vector<T>(sortedSample));
+    std::vector<ConfidenceInterval> intervals;
+    for (std::size_t m = 0; m < metrics.size(); m++)
+    {
+        auto& samples = values[m];
+        samples.erase(std::remove_if(samples.begin(), samples.end(), [](double v) { return std::isnan(v); }),
+                      samples.end());
+        double estimate = metrics[m](sampleStatistics);
+        if (samples.empty())
+            intervals.push_back(ConfidenceInterval {estimate, NAN, NAN});
+        else
+            intervals.push_back(bootstrap_detail::percentileInterval(estimate, samples, confidenceLevel));
+    }
+    return intervals;
+}
+
+#endif //PROJ1_SAMPLING_H
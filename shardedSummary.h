@@ -0,0 +1,305 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_SHARDEDSUMMARY_H
+#define PROJ1_SHARDEDSUMMARY_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "streamSummary.h"
+#include "summaryEncoding.h"
+#include "ingestPipeline.h"
+#include "ui/UIExcept.h"
+#include "ui/configuration.h"
+
+template <typename T>
+struct ShardedSummary
+{
+    StreamSummary<T> summary;
+    std::size_t shards = 0;
+    std::size_t skippedTokens = 0;
+};
+
+namespace shard_detail
+{
+    // room of each worker in the shared segment, a summary takes some 100 KiB at most
+    constexpr std::size_t SLOT_BYTES = 1 << 20;
+    // a token longer than this is not a number, it is dropped instead of being kept whole
+    constexpr std::size_t MAX_TOKEN_LENGTH = 64;
+
+    enum class SlotState : std::uint32_t
+    {
+        Empty,
+        Done,
+        Failed
+    };
+
+    /// Start of the slot of a worker, followed by its encoded summary
+    struct SlotHeader
+    {
+        SlotState state;
+        std::uint64_t bytes;
+        std::uint64_t skippedTokens;
+        char error[240];
+    };
+
+    /** A POSIX shared memory segment mapped by this process. Its name is removed at once:
+     *  worker processes forked afterwards share the mapping, and nothing is left behind
+     *  however the processes end.
+     */
+    class SharedSegment
+    {
+    public:
+        explicit SharedSegment(std::size_t _size) : size {_size}
+        {
+            auto name = "/proj1-shards-" + std::to_string(::getpid());
+            int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+            if (fd < 0)
+                throw UIExcept(std::string("Cannot create shared memory: ") + std::strerror(errno));
+            ::shm_unlink(name.c_str());
+            if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+            {
+                ::close(fd);
+                throw UIExcept(std::string("Cannot size shared memory: ") + std::strerror(errno));
+            }
+            void* mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (mapped == MAP_FAILED)
+                throw UIExcept(std::string("Cannot map shared memory: ") + std::strerror(errno));
+            data = static_cast<char*>(mapped);
+        }
+
+        SharedSegment(const SharedSegment&) = delete;
+        SharedSegment& operator=(const SharedSegment&) = delete;
+
+        ~SharedSegment()
+        {
+            ::munmap(data, size);
+        }
+
+        char* get() const
+        {
+            return data;
+        }
+
+    private:
+        std::size_t size;
+        char* data = nullptr;
+    };
+
+    /// Bytes read at offset, 0 at the end of the file
+    inline std::size_t readAt(int fd, char* buffer, std::size_t size, std::size_t offset)
+    {
+        ssize_t count;
+        while ((count = ::pread(fd, buffer, size, static_cast<off_t>(offset))) < 0 && errno == EINTR)
+            ;
+        if (count < 0)
+            throw UIExcept(std::string("Cannot read file: ") + std::strerror(errno));
+        return count;
+    }
+
+    /** Add the values of fd whose first character is in [begin, end) to summary, so that the
+     *  ranges of all shards together take every value once. Reads past end only to finish
+     *  the last value. Returns the tokens that are not numbers, which are skipped.
+     */
+    template <typename T>
+    std::size_t summarizeRange(int fd, std::size_t begin, std::size_t end, StreamSummary<T>& summary)
+    {
+        using namespace ingest_detail;
+        std::size_t skipped = 0;
+        char buffer[CHUNK_BYTES];
+        std::size_t offset = begin;
+        // bytes read but not parsed yet, the first of them at pendingOffset
+        std::string pending;
+        std::size_t pendingOffset = begin;
+        // a token cut by begin belongs to the previous shard, like the rest of a token too long
+        char before = ' ';
+        bool dropping = begin > 0 && readAt(fd, &before, 1, begin - 1) == 1 && !isSpace(before);
+        bool finished = begin >= end;
+        while (!finished)
+        {
+            std::size_t count = readAt(fd, buffer, sizeof(buffer), offset);
+            bool atEnd = count == 0;
+            offset += count;
+            pending.append(buffer, count);
+            if (dropping)
+            {
+                auto tokenEnd = std::find_if(pending.cbegin(), pending.cend(), isSpace);
+                dropping = tokenEnd == pending.cend() && !atEnd;
+                pendingOffset += tokenEnd - pending.cbegin();
+                pending.erase(pending.cbegin(), tokenEnd);
+            }
+
+            // the token at the end may go on in the next read
+            std::size_t complete = pending.size();
+            while (!atEnd && complete > 0 && !isSpace(pending[complete - 1]))
+                complete--;
+            const char* base = pending.data();
+            const char* first = base;
+            const char* last = base + complete;
+            while (true)
+            {
+                while (first != last && isSpace(*first))
+                    first++;
+                if (first == last)
+                    break;
+                if (pendingOffset + (first - base) >= end)
+                {
+                    finished = true;
+                    break;
+                }
+                T value;
+                if (parseNextToken(first, last, value) == Parsed::Value)
+                    summary.add(value);
+                else
+                    skipped++;
+            }
+            pending.erase(0, complete);
+            pendingOffset += complete;
+            if (atEnd)
+                break;
+            if (!finished && pending.size() > MAX_TOKEN_LENGTH)
+            {
+                finished = pendingOffset >= end;
+                if (!finished)
+                    skipped++;
+                pendingOffset += pending.size();
+                pending.clear();
+                dropping = true;
+            }
+        }
+        return skipped;
+    }
+
+    /// Work of the worker process of shard, which ends the process
+    template <typename T>
+    [[noreturn]] void runShard(int fd, std::size_t shard, std::size_t begin, std::size_t end, char* slot)
+    {
+        auto& header = *reinterpret_cast<SlotHeader*>(slot);
+        int status = 0;
+        try
+        {
+            auto summary = StreamSummary<T>();
+            summary.quantiles = QuantileSketch<T>(config::SKETCH_K, config::SAMPLE_SEED, shard);
+            header.skippedTokens = summarizeRange(fd, begin, end, summary);
+            std::string bytes;
+            encodeSummary(summary, bytes);
+            if (bytes.size() > SLOT_BYTES - sizeof(SlotHeader))
+                throw UIExcept("The summary of a shard does not fit in shared memory");
+            std::memcpy(slot + sizeof(SlotHeader), bytes.data(), bytes.size());
+            header.bytes = bytes.size();
+            header.state = SlotState::Done;
+        }
+        catch (UIExcept& e)
+        {
+            std::strncpy(header.error, e.what().c_str(), sizeof(header.error) - 1);
+            header.state = SlotState::Failed;
+            status = 1;
+        }
+        catch (std::exception& e)
+        {
+            std::strncpy(header.error, e.what(), sizeof(header.error) - 1);
+            header.state = SlotState::Failed;
+            status = 1;
+        }
+        // exit without the destructors and stdio buffers of the parent, which go on there
+        ::_exit(status);
+    }
+}
+
+/** Summary of the file at path computed by processCount forked worker processes, each over
+ *  its own byte range of the file. The workers leave their summaries in one POSIX shared
+ *  memory segment, encoded like encodeSummary does, and this process merges them. A worker
+ *  holds only its summary and a chunk of its range, however large the file is.
+ */
+template <typename T>
+ShardedSummary<T> summarizeInProcesses(const std::string& path, std::size_t processCount)
+{
+    using namespace shard_detail;
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw UIExcept("Cannot open file " + path);
+    struct stat status {};
+    if (::fstat(fd, &status) != 0)
+    {
+        ::close(fd);
+        throw UIExcept("Cannot read file " + path);
+    }
+    auto fileSize = static_cast<std::size_t>(status.st_size);
+    processCount = std::max<std::size_t>(1, std::min(processCount, std::max<std::size_t>(fileSize, 1)));
+
+    std::optional<SharedSegment> segment;
+    try
+    {
+        segment.emplace(processCount * SLOT_BYTES);
+    }
+    catch (UIExcept&)
+    {
+        ::close(fd);
+        throw;
+    }
+    // what is buffered would otherwise be written again by every worker
+    std::cout.flush();
+    std::cerr.flush();
+
+    std::vector<pid_t> workers;
+    std::string forkError;
+    for (std::size_t shard = 0; shard < processCount; shard++)
+    {
+        std::size_t begin = fileSize * shard / processCount;
+        std::size_t end = fileSize * (shard + 1) / processCount;
+        pid_t pid = ::fork();
+        if (pid == 0)
+            runShard<T>(fd, shard, begin, end, segment->get() + shard * SLOT_BYTES);
+        if (pid < 0)
+        {
+            forkError = std::string("Cannot start worker process: ") + std::strerror(errno);
+            break;
+        }
+        workers.push_back(pid);
+    }
+    ::close(fd);
+
+    std::vector<std::string> failures;
+    for (std::size_t shard = 0; shard < workers.size(); shard++)
+    {
+        int exitStatus = 0;
+        while (::waitpid(workers[shard], &exitStatus, 0) < 0 && errno == EINTR)
+            ;
+        if (WIFSIGNALED(exitStatus))
+            failures.push_back("Worker of shard " + std::to_string(shard) + " was killed by signal "
+                               + std::to_string(WTERMSIG(exitStatus)));
+    }
+    if (!forkError.empty())
+        throw UIExcept(forkError);
+    if (!failures.empty())
+        throw UIExcept(failures.front());
+
+    auto result = ShardedSummary<T>();
+    result.shards = workers.size();
+    for (std::size_t shard = 0; shard < workers.size(); shard++)
+    {
+        const char* slot = segment->get() + shard * SLOT_BYTES;
+        const auto& header = *reinterpret_cast<const SlotHeader*>(slot);
+        if (header.state != SlotState::Done || header.bytes > SLOT_BYTES - sizeof(SlotHeader))
+            throw UIExcept("Shard " + std::to_string(shard) + " failed: "
+                           + (header.state == SlotState::Failed ? std::string(header.error) : "no summary"));
+        result.summary.merge(decodeSummary<T>(std::string_view(slot + sizeof(SlotHeader), header.bytes)));
+        result.skippedTokens += header.skippedTokens;
+    }
+    return result;
+}
+
+#endif //PROJ1_SHARDEDSUMMARY_H
@@ -0,0 +1,110 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_SNAPSHOT_H
+#define PROJ1_SNAPSHOT_H
+
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <utility>
+
+template <typename T>
+class Versioned;
+
+/** A version of a value that does not change. The version stays alive, and readable, for as
+ *  long as a snapshot of it exists, whatever was published after it.
+ */
+template <typename T>
+class Snapshot
+{
+public:
+    Snapshot() = default;
+
+    const T& operator*() const { return *version->value; }
+    const T* operator->() const { return version->value.get(); }
+    explicit operator bool() const { return version != nullptr; }
+
+    /// 1 for the first value published, counting up
+    std::uint64_t getVersion() const { return version->number; }
+
+private:
+    friend class Versioned<T>;
+
+    struct Version
+    {
+        std::uint64_t number;
+        std::shared_ptr<const T> value;
+    };
+
+    std::shared_ptr<const Version> version;
+
+    explicit Snapshot(std::shared_ptr<const Version> _version) : version {std::move(_version)} {}
+};
+
+/** The current version of a value, read by any number of threads while writers replace it.
+ *
+ *  Readers pin the current version by copying one shared_ptr with std::atomic_load. The
+ *  standard library may guard that copy with a short internal lock, held only for the copy,
+ *  but readers never wait for writers. A writer builds the next value on the side and
+ *  publishes it with one atomic store, so a reader sees either the old value or the new one,
+ *  never a value being built. A version is freed when the last snapshot of it is destroyed, which is the
+ *  grace period of read-copy-update kept by reference counts instead of epochs.
+ *
+ *  Writers are serialized with each other, so an update is always based on the latest version.
+ */
+template <typename T>
+class Versioned
+{
+public:
+    Versioned() = default;
+
+    explicit Versioned(std::shared_ptr<const T> value)
+    {
+        publish(std::move(value));
+    }
+
+    Versioned(const Versioned&) = delete;
+    Versioned& operator=(const Versioned&) = delete;
+
+    /// The current version, empty when nothing was published yet
+    Snapshot<T> pin() const
+    {
+        return Snapshot<T>(std::atomic_load(&current));
+    }
+
+    /// Make value the current version, returns its version number
+    std::uint64_t publish(std::shared_ptr<const T> value)
+    {
+        auto lock = std::lock_guard<std::mutex>(writing);
+        return store(std::move(value));
+    }
+
+    /** Publish makeNext(current snapshot), which returns the next value as a shared_ptr<const T>.
+     *  Other writers wait while makeNext runs, readers do not. Nothing is published when
+     *  makeNext throws. Returns the version number of the new value.
+     */
+    template <typename MakeNext>
+    std::uint64_t update(MakeNext makeNext)
+    {
+        auto lock = std::lock_guard<std::mutex>(writing);
+        return store(makeNext(Snapshot<T>(std::atomic_load(&current))));
+    }
+
+private:
+    using Version = typename Snapshot<T>::Version;
+
+    std::shared_ptr<const Version> current;
+    std::mutex writing;
+    std::uint64_t lastNumber = 0;
+
+    std::uint64_t store(std::shared_ptr<const T> value)
+    {
+        auto next = std::make_shared<const Version>(Version {++lastNumber, std::move(value)});
+        std::atomic_store(&current, std::move(next));
+        return lastNumber;
+    }
+};
+
+#endif //PROJ1_SNAPSHOT_H
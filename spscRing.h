@@ -0,0 +1,99 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_SPSCRING_H
+#define PROJ1_SPSCRING_H
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <utility>
+
+/** Bounded queue between exactly one producer thread and one consumer thread, without locks:
+ *  each side only writes its own index, and reads the other one to know how full the ring is.
+ *  The capacity is rounded up to a power of two.
+ */
+template <typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(std::size_t minimumCapacity)
+    {
+        std::size_t capacity = 1;
+        while (capacity < minimumCapacity)
+            capacity *= 2;
+        slots.resize(capacity);
+        mask = capacity - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /// Producer side, false when the ring is full. item is moved from only when it was pushed.
+    bool tryPush(T& item)
+    {
+        std::size_t currentTail = tail.load(std::memory_order_relaxed);
+        if (currentTail - head.load(std::memory_order_acquire) == slots.size())
+            return false;
+        slots[currentTail & mask] = std::move(item);
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer side, false when the ring is empty
+    bool tryPop(T& item)
+    {
+        std::size_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead == tail.load(std::memory_order_acquire))
+            return false;
+        item = std::move(slots[currentHead & mask]);
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t getCapacity() const
+    {
+        return slots.size();
+    }
+
+private:
+    std::vector<T> slots;
+    std::size_t mask;
+    // each index on its own cache line, so the two sides do not invalidate each other's
+    alignas(64) std::atomic<std::size_t> head {0};
+    alignas(64) std::atomic<std::size_t> tail {0};
+};
+
+/** Waiting of a thread on a lock-free structure: spins a little, then yields, then sleeps,
+ *  so a stage that waits long does not take the core from the stage it waits for.
+ */
+class Backoff
+{
+public:
+    void pause()
+    {
+        if (rounds < SPIN_ROUNDS)
+            ;
+        else if (rounds < SPIN_ROUNDS + YIELD_ROUNDS)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(SLEEP_MICROSECONDS));
+        rounds++;
+    }
+
+    void reset()
+    {
+        rounds = 0;
+    }
+
+private:
+    static constexpr int SPIN_ROUNDS = 64;
+    static constexpr int YIELD_ROUNDS = 64;
+    static constexpr int SLEEP_MICROSECONDS = 50;
+
+    int rounds = 0;
+};
+
+#endif //PROJ1_SPSCRING_H
@@ -13,7 +13,16 @@
 #include <cmath>
 #include <functional>
 #include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "ui/Table.h"
+#include "ui/UIExcept.h"
+#include "moments.h"
+#include "momentTree.h"
+#include "histogram.h"
+#include "bootstrap.h"
+#include "ingestPipeline.h"
 
 using namespace std;
 
@@ -31,37 +40,112 @@ public:
         double frequencyPercentage;
     };
 
-    void loadDataFromFilePath(string path)
+    /** beforeSort, when given, sees the loaded elements in file order. progress, when given, is
+     *  told the bytes read of the whole file now and then; an exception it throws stops the load
+     *  and leaves the elements that were loaded before.
+     */
+    void loadDataFromFilePath(string path, const function<void(const vector<T>&)>& beforeSort = nullptr,
+                              const function<void(size_t bytesRead, size_t totalBytes)>& progress = nullptr)
     {
-        ifstream statsFile(path);
-        if (statsFile.is_open())
+        loadData(readValuesFromFile(path, progress), beforeSort);
+    }
+
+    /// Replace the elements with values, given in series order
+    void loadData(vector<T> loaded, const function<void(const vector<T>&)>& beforeSort = nullptr)
+    {
+        auto loadedTree = keepsLoadOrder ? MomentTree<T>(loaded) : MomentTree<T>();
+        if (beforeSort)
+            beforeSort(loaded);
+        sort(loaded.begin(), loaded.end());
+
+        clear();
+        elements = move(loaded);
+        rangeTree = move(loadedTree);
+    }
+
+    /** The elements of base followed by those of the file at path. base is only read, so other
+     *  threads may keep reading it meanwhile; this must not be base. The load order is kept
+     *  when base keeps it.
+     */
+    void loadAppendedData(const Statistics& base, string path)
+    {
+        auto appended = readValuesFromFile(path, nullptr);
+        auto appendedTree = MomentTree<T>();
+        if (base.keepsLoadOrder)
+        {
+            auto series = base.rangeTree.getSeries();
+            series.insert(series.end(), appended.cbegin(), appended.cend());
+            appendedTree = MomentTree<T>(move(series));
+        }
+        sort(appended.begin(), appended.end());
+        vector<T> merged(base.elements.size() + appended.size());
+        std::merge(base.elements.cbegin(), base.elements.cend(), appended.cbegin(), appended.cend(), merged.begin());
+
+        clear();
+        keepsLoadOrder = base.keepsLoadOrder;
+        elements = move(merged);
+        rangeTree = move(appendedTree);
+    }
+
+    /** Values of the file at path in file order, read and parsed on an IngestPipeline while
+     *  they are collected. progress, when given, is told the bytes read of the whole file
+     *  after every batch of values.
+     */
+    static vector<T> readValuesFromFile(const string& path,
+                                        const function<void(size_t bytesRead, size_t totalBytes)>& progress)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw UIExcept("Cannot open file");
+        struct stat status {};
+        size_t totalBytes = ::fstat(fd, &status) == 0 ? static_cast<size_t>(status.st_size) : 0;
+        vector<T> values;
+        auto counters = IngestCounters();
+        try
+        {
+            ingestValues<T>(fd, counters, [&](const vector<T>& batch)
+            {
+                values.insert(values.end(), batch.cbegin(), batch.cend());
+                if (progress)
+                    progress(counters.reading.processed.load(memory_order_relaxed), totalBytes);
+            });
+        }
+        catch (...)
         {
-            clear();
-            T currentValue;
-            while (statsFile >> currentValue)
-                elements.push_back(currentValue);
-            sort(elements.begin(), elements.end());
+            ::close(fd);
+            throw;
         }
-        else throw UIExcept("Cannot open file");
+        ::close(fd);
+        if (progress)
+            progress(totalBytes, totalBytes);
+        return values;
     }
 
     void clear()
     {
         elements.clear();
-        _meanCache.reset();
-        _sumCache.reset();
-        _varianceCache.reset();
-        _quartilesCache.reset();
+        clearCaches();
+        rangeTree.clear();
     }
 
     Statistics() :
         elements {}
     {}
+    /// Statistics of elements, which are sorted; range queries are not offered on them
     Statistics(vector<T>&& elements)
     :
     elements {move(elements)}
     {
-        sort(elements.begin(), elements.end());
+        sort(this->elements.begin(), this->elements.end());
+    }
+
+    /** Whether the loads that follow also keep the values in load order, for range queries.
+     *  That is a MomentTree with its own copy of the values, which doubles the memory taken,
+     *  so it is off unless range queries are offered.
+     */
+    void keepLoadOrder(bool keep)
+    {
+        keepsLoadOrder = keep;
     }
 
     const T& getMin() const
@@ -73,7 +157,7 @@ public:
         return elements.back();
     }
 
-    const T getRange()
+    const T getRange() const
     {
         return getMax() - getMin();
     }
@@ -85,7 +169,7 @@ public:
         else
         {
             _sumCache.emplace(
-                accumulate(elements.cbegin(), elements.cend(), 0, plus<>())
+                accumulate(elements.cbegin(), elements.cend(), T {}, plus<>())
             );
             return _sumCache.value();
         }
@@ -96,6 +180,12 @@ public:
         return elements.size();
     }
 
+    /// The values, sorted
+    const vector<T>& getElements() const
+    {
+        return elements;
+    }
+
     const double& getMean() const
     {
         if (_meanCache.has_value())
@@ -114,16 +204,14 @@ public:
 
     std::vector<T> getMode() const
     {
-        auto freqTable = getFrequencyTable();
-        auto maxEntry = std::max_element(freqTable.cbegin(), freqTable.cend(),
-                                         [](const FrequencyEntry& entry1, const  FrequencyEntry& entry2)
-                                         {
-                                                return entry1.frequency < entry2.frequency;
-                                         });
+        long maxFrequency = 0;
+        FrequencyEntry entry;
+        for (auto cursor = getFrequencyCursor(); cursor.next(entry);)
+            maxFrequency = std::max(maxFrequency, entry.frequency);
         auto modeElements = std::vector<T>();
-        for (auto& entry : freqTable)
+        for (auto cursor = getFrequencyCursor(); cursor.next(entry);)
         {
-            if (entry.frequency >= maxEntry->frequency)
+            if (entry.frequency >= maxFrequency)
                 modeElements.push_back(entry.value);
         }
         return modeElements;
@@ -186,6 +274,27 @@ public:
         }
     }
 
+    /// Quantile p in [0, 1], interpolated linearly between the two closest ranks
+    double getQuantile(double p) const
+    {
+        double rank = p * (getSize() - 1);
+        size_t below = static_cast<size_t>(rank);
+        if (below + 1 >= getSize())
+            return elements.back();
+        return elements[below] + (rank - below) * (elements[below + 1] - elements[below]);
+    }
+
+    /** Compute every cached statistic now. The const getters do not write afterwards, so
+     *  several threads may read the statistics at once.
+     */
+    void fillCaches() const
+    {
+        getSum();
+        getMean();
+        getVariance();
+        getQuartiles();
+    }
+
     optional<double> getIQR() const
     {
         auto& quartiles = getQuartiles();
@@ -299,37 +408,186 @@ public:
         return getKurtosis() + adjustmentTerm;
     }
 
-    std::vector<FrequencyEntry> getFrequencyTable() const
+    /** Frequency entries of a sorted range, computed one at a time in increasing
+     *  order of value. Nothing is stored per entry. A cursor stays valid while the
+     *  elements it was taken from are unchanged and can be copied to remember a position.
+     */
+    class FrequencyCursor
     {
-        auto frequencyTable = std::vector<FrequencyEntry> ();
-        auto it = elements.cbegin();
-        while (it != elements.cend())
+    public:
+        using Iterator = typename vector<T>::const_iterator;
+
+        FrequencyCursor() = default;
+
+        FrequencyCursor(Iterator _first, Iterator _last, std::size_t _totalFrequency)
+        :
+        current {_first},
+        last {_last},
+        totalFrequency {_totalFrequency}
+        {}
+
+        bool isExhausted() const
         {
-            auto frequencyEntry = FrequencyEntry {
-                .value = *it,
-                .frequency = 1,
-                .frequencyPercentage = 0
-            };
-            while (it != elements.cend() && * ++it == frequencyEntry.value)
-                frequencyEntry.frequency++;
-            frequencyTable.push_back(frequencyEntry);
+            return current == last;
         }
 
-        long totalFrequency = std::transform_reduce(
-            frequencyTable.cbegin(), frequencyTable.cend(),
-            0,
-            std::plus<>(),
-            [](const FrequencyEntry& entry) { return entry.frequency; }
-        );
-        for (auto& entry: frequencyTable)
+        /// Store the next entry, false when there is none left
+        bool next(FrequencyEntry& entry)
         {
+            if (isExhausted())
+                return false;
+            auto runEnd = findRunEnd();
+            entry.value = *current;
+            entry.frequency = runEnd - current;
             entry.frequencyPercentage = static_cast<double>(entry.frequency) / totalFrequency;
+            current = runEnd;
+            return true;
         }
+
+        /// Move past count entries or to the end, whichever comes first
+        void skip(std::size_t count)
+        {
+            for (; count > 0 && !isExhausted(); count--)
+                current = findRunEnd();
+        }
+
+    private:
+        Iterator current;
+        Iterator last;
+        std::size_t totalFrequency = 0;
+
+        // Galloping search: long runs cost O(log length) comparisons, single values one.
+        Iterator findRunEnd() const
+        {
+            const T& value = *current;
+            auto low = std::next(current);
+            auto high = low;
+            std::ptrdiff_t step = 1;
+            while (high != last && *high == value)
+            {
+                low = std::next(high);
+                step *= 2;
+                high = last - low > step ? low + step : last;
+            }
+            return std::upper_bound(low, high, value);
+        }
+    };
+
+    FrequencyCursor getFrequencyCursor() const
+    {
+        return FrequencyCursor(elements.cbegin(), elements.cend(), elements.size());
+    }
+
+    /// Cursor over the count largest distinct values
+    FrequencyCursor getLastFrequencies(std::size_t count) const
+    {
+        auto first = elements.cend();
+        for (; count > 0 && first != elements.cbegin(); count--)
+            first = std::lower_bound(elements.cbegin(), first, *std::prev(first));
+        return FrequencyCursor(first, elements.cend(), elements.size());
+    }
+
+    std::size_t getDistinctCount() const
+    {
+        std::size_t distinctCount = 0;
+        for (auto cursor = getFrequencyCursor(); !cursor.isExhausted(); cursor.skip(1))
+            distinctCount++;
+        return distinctCount;
+    }
+
+    /// The count most frequent values, most frequent first and smaller values first on ties.
+    /// Only count entries are kept in memory at any time.
+    std::vector<FrequencyEntry> getMostFrequent(std::size_t count) const
+    {
+        auto moreFrequent = [](const FrequencyEntry& entry1, const FrequencyEntry& entry2)
+        {
+            return entry1.frequency != entry2.frequency ? entry1.frequency > entry2.frequency
+                                                        : entry1.value < entry2.value;
+        };
+        // heap whose top is the least frequent of the entries kept so far
+        auto mostFrequent = std::vector<FrequencyEntry>();
+        mostFrequent.reserve(std::min(count, elements.size()));
+        FrequencyEntry entry;
+        for (auto cursor = getFrequencyCursor(); count > 0 && cursor.next(entry);)
+        {
+            if (mostFrequent.size() < count)
+            {
+                mostFrequent.push_back(entry);
+                std::push_heap(mostFrequent.begin(), mostFrequent.end(), moreFrequent);
+            }
+            else if (moreFrequent(entry, mostFrequent.front()))
+            {
+                std::pop_heap(mostFrequent.begin(), mostFrequent.end(), moreFrequent);
+                mostFrequent.back() = entry;
+                std::push_heap(mostFrequent.begin(), mostFrequent.end(), moreFrequent);
+            }
+        }
+        std::sort_heap(mostFrequent.begin(), mostFrequent.end(), moreFrequent);
+        return mostFrequent;
+    }
+
+    std::vector<FrequencyEntry> getFrequencyTable() const
+    {
+        auto frequencyTable = std::vector<FrequencyEntry> ();
+        FrequencyEntry entry;
+        for (auto cursor = getFrequencyCursor(); cursor.next(entry);)
+            frequencyTable.push_back(entry);
         return frequencyTable;
     }
 
+    Histogram getHistogram(BinningScheme scheme, size_t binCount) const
+    {
+        return buildHistogram(elements.data(), elements.size(), scheme, binCount);
+    }
+
+    /// confidenceLevel is a fraction, e.g. 0.95
+    BootstrapResult getBootstrapIntervals(size_t resampleCount, double confidenceLevel, uint64_t seed) const
+    {
+        return bootstrapConfidenceIntervals(elements, resampleCount, confidenceLevel, seed);
+    }
+
+    /// Range queries over the elements in the order they were loaded, [first, last).
+    Moments<T> getRangeMoments(size_t first, size_t last) const
+    {
+        if (!keepsLoadOrder)
+            throw UIExcept("Range queries are not offered on these values");
+        if (rangeTree.getSize() == 0)
+            throw UIExcept("Range queries need the data to be fully loaded");
+        if (first >= last || last > rangeTree.getSize())
+            throw UIExcept("Invalid index range");
+        return rangeTree.query(first, last);
+    }
+
+    T getRangeMin(size_t first, size_t last) const
+    {
+        return getRangeMoments(first, last).min;
+    }
+
+    T getRangeMax(size_t first, size_t last) const
+    {
+        return getRangeMoments(first, last).max;
+    }
+
+    T getRangeSum(size_t first, size_t last) const
+    {
+        return getRangeMoments(first, last).sum;
+    }
+
+    double getRangeMean(size_t first, size_t last) const
+    {
+        return getRangeMoments(first, last).getMean();
+    }
+
+    double getRangeVariance(size_t first, size_t last) const
+    {
+        return getRangeMoments(first, last).getVariance();
+    }
+
 protected:
     std::vector<T> elements;
+    // pre-aggregated moments over the elements in load order, when keepsLoadOrder
+    MomentTree<T> rangeTree;
+    bool keepsLoadOrder = false;
 
     // caches for statistics that are used many times
     mutable std::optional<T> _sumCache;
@@ -338,6 +596,14 @@ protected:
     mutable std::optional<Quartiles> _quartilesCache;
 
     /// Helpers
+    void clearCaches()
+    {
+        _meanCache.reset();
+        _sumCache.reset();
+        _varianceCache.reset();
+        _quartilesCache.reset();
+    }
+
     std::optional<double> getMedianInRange(decltype(elements.cbegin()) lowBound, decltype(elements.cbegin()) highBound) const
     {
         ptrdiff_t distance = std::distance(lowBound, highBound);
@@ -0,0 +1,318 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_STATISTICSREPORT_H
+#define PROJ1_STATISTICSREPORT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <type_traits>
+#include "statistics.h"
+#include "sampling.h"
+#include "reportWriter.h"
+#include "ui/MixedColumn.h"
+#include "ui/StreamingColumn.h"
+#include "ui/TypedTable.h"
+#include "ui/RenderArena.h"
+#include "ui/OutputSink.h"
+#include "ui/configuration.h"
+
+/** Every statistic of a data set, as the table of option W or streamed to a ReportWriter.
+ *  Only reads the statistics, so datasets that are shared between threads are reported too.
+ *  When the values are a sample of a file, estimates holds the size and sum of the whole
+ *  file, and each statistic is shown with its bootstrap confidence interval.
+ */
+class StatisticsReport
+{
+public:
+    using QuartilesTable = TypedTable<Col<const char*>, Col<const wchar_t*>, Col<std::optional<double>>>;
+    // with the confidence interval of each quartile
+    using SampleQuartilesTable = TypedTable<Col<const char*>, Col<const wchar_t*>, Col<std::optional<double>>,
+                                            Col<std::wstring>>;
+    using FrequencyTable = TypedTable<Col<long>, Col<long>, Col<double>>;
+    using FrequencyEntry = Statistics<long>::FrequencyEntry;
+    using FrequencyCursor = Statistics<long>::FrequencyCursor;
+    using Quartiles = Statistics<long>::Quartiles;
+
+    /// Size and sum of the file the values were sampled from
+    struct PopulationEstimates
+    {
+        ConfidenceInterval size;
+        ConfidenceInterval sum;
+    };
+
+    explicit StatisticsReport(const Statistics<long>& _statistics,
+                              std::optional<PopulationEstimates> _estimates = std::nullopt)
+        :
+        statistics {_statistics},
+        estimates {std::move(_estimates)}
+    {}
+
+    bool isApproximate() const
+    {
+        return estimates.has_value();
+    }
+
+    /// Metric usable on a resample, or nullopt when the statistic is not a single number.
+    template <typename Getter>
+    static std::optional<SampleMetric<long>> toSampleMetric(Getter statsGetter)
+    {
+        using Result = std::decay_t<std::invoke_result_t<Getter, const Statistics<long>&>>;
+        if constexpr (std::is_arithmetic_v<Result>)
+            return SampleMetric<long>([statsGetter](const Statistics<long>& statistics)
+                                      { return static_cast<double>(std::invoke(statsGetter, statistics)); });
+        else if constexpr (std::is_same_v<Result, std::optional<double>>)
+            return SampleMetric<long>([statsGetter](const Statistics<long>& statistics)
+                                      { return std::invoke(statsGetter, statistics).value_or(NAN); });
+        else
+            return std::nullopt;
+    }
+
+    std::vector<ConfidenceInterval> getSampleIntervals(const std::vector<SampleMetric<long>>& metrics) const
+    {
+        return bootstrapMetricIntervals(statistics.getElements(), metrics, config::SAMPLE_BOOTSTRAP_RESAMPLES,
+                                        config::SAMPLE_CONFIDENCE_LEVEL, config::SAMPLE_SEED);
+    }
+
+    static std::wstring intervalToString(const ConfidenceInterval& interval)
+    {
+        std::wostringstream os;
+        os << 100 * config::SAMPLE_CONFIDENCE_LEVEL << L"% CI ";
+        if (std::isnan(interval.lower))
+            os << L"None";
+        else
+            os << std::fixed << std::setprecision(config::FLOAT_NUMBER_DIGITS)
+               << L"[" << interval.lower << L", " << interval.upper << L"]";
+        return os.str();
+    }
+
+    /// Quartiles, with their confidence intervals when the elements are a sample
+    AbstractTable* quartilesToUITable(RenderArena& arena, const Quartiles& quartiles, std::wstring_view title,
+                                      int consoleWidth = config::CONSOLE_WIDTH, bool selfCentered = true) const
+    {
+        if (!isApproximate())
+        {
+            auto table = arena.create<QuartilesTable>(QuartilesTable::Columns {}, title, consoleWidth, selfCentered);
+            table->addRow("Q1", L"-->", quartiles.Q1);
+            table->addRow("Q2", L"-->", quartiles.Q2);
+            table->addRow("Q3", L"-->", quartiles.Q3);
+            return table;
+        }
+        auto intervals = getSampleIntervals({
+            [](const Statistics<long>& statistics) { return statistics.getQuartiles().Q1.value_or(NAN); },
+            [](const Statistics<long>& statistics) { return statistics.getQuartiles().Q2.value_or(NAN); },
+            [](const Statistics<long>& statistics) { return statistics.getQuartiles().Q3.value_or(NAN); }
+        });
+        auto table = arena.create<SampleQuartilesTable>(SampleQuartilesTable::Columns {}, title, consoleWidth, selfCentered);
+        table->addRow("Q1", L"-->", quartiles.Q1, intervalToString(intervals.at(0)));
+        table->addRow("Q2", L"-->", quartiles.Q2, intervalToString(intervals.at(1)));
+        table->addRow("Q3", L"-->", quartiles.Q3, intervalToString(intervals.at(2)));
+        return table;
+    }
+
+    /** Frequency table whose rows are computed from the sorted elements while it is
+     *  rendered. Nothing is stored per row, so it can show millions of distinct values.
+     */
+    static FrequencyTable* frequencyTableToUITable(RenderArena& arena, RowStream<FrequencyEntry>& entries,
+                                                   std::wstring_view title = L"")
+    {
+        auto toRow = [](const FrequencyEntry& entry)
+        {
+            return FrequencyTable::Row(entry.value, entry.frequency, 100 * entry.frequencyPercentage);
+        };
+        auto rows = arena.create<TransformedRowStream<FrequencyEntry, FrequencyTable::Row, decltype(toRow)>>(entries, toRow);
+        return arena.create<FrequencyTable>(
+            *rows,
+            FrequencyTable::Columns {{L"Values"}, {L"Frequency"}, {L"Percentage"}},
+            title, -1, false);
+    }
+
+    /// Entries of the cursor, at most count of them
+    static RowStream<FrequencyEntry>& frequencyRows(RenderArena& arena, const FrequencyCursor& cursor, std::size_t count)
+    {
+        return *arena.create<CursorRowStream<FrequencyCursor, FrequencyEntry>>(cursor, count);
+    }
+
+    /// Table of every statistic, as shown by option W
+    Table* toUITable(RenderArena& arena) const
+    {
+        auto statisticNameColumn = arena.create<MixedColumn>(0, 5, L"Concept");
+        statisticNameColumn->addItems(
+        L"Minimum",
+        L"Maximum",
+        L"Range",
+        L"Size",
+        L"Sum",
+        L"Mean",
+        L"Median",
+        L"Mode",
+        L"Standard Deviation",
+        L"Variance",
+        L"Mid Range",
+        L"Quartiles",
+        L"Interquartile Range",
+        L"Outliers",
+        L"Sum of Squares",
+        L"Mean Absolute Deviation",
+        L"Root Mean Square",
+        L"Standard Error of the Mean",
+        L"Skewness",
+        L"Kurtosis",
+        L"Kurtosis Excess",
+        L"Coefficient of Variation",
+        L"Relative Standard Deviation",
+        L"Frequency Table");
+
+        auto* quartileTable = quartilesToUITable(arena, statistics.getQuartiles(), L"", -1, false);
+
+        auto statisticValueColumn = arena.create<MixedColumn>(0, 5, L"Values");
+        statisticValueColumn->addItems(
+            statistics.getMin(),
+            statistics.getMax(),
+            statistics.getRange(),
+            isApproximate() ? static_cast<std::size_t>(std::llround(estimates->size.estimate)) : statistics.getSize(),
+            isApproximate() ? std::llround(estimates->sum.estimate) : statistics.getSum(),
+            statistics.getMean(),
+            statistics.getMedian(),
+            statistics.getMode(),
+            statistics.getStandardDeviation(),
+            statistics.getVariance(),
+            statistics.getMidRange(),
+            quartileTable,
+            statistics.getIQR(),
+            statistics.getOutliers(),
+            statistics.getSumOfSquares(),
+            statistics.getMeanAbsoluteDeviation(),
+            statistics.getRootMeanSquare(),
+            statistics.getStdErrorOfMean(),
+            statistics.getSkewness(),
+            statistics.getKurtosis(),
+            statistics.getKurtosisExcess(),
+            statistics.getCoefficientOfVariation(),
+            to_wstring(statistics.getRelativeStd()) + L"%",
+            frequencyTableToUITable(arena, frequencyRows(arena, statistics.getFrequencyCursor(), statistics.getSize()))
+        );
+
+        auto equalColumn = arena.create<MixedColumn>(0, 2, L"");
+        for (std::size_t row = 0; row < 24; row++)
+            equalColumn->addItems('=');
+
+        auto columns = std::pmr::vector<AbstractColumn*>({statisticNameColumn, equalColumn}, arena.getAllocator());
+        if (isApproximate())
+            columns.push_back(sampleIntervalsToUIColumn(arena));
+        columns.push_back(statisticValueColumn);
+        return arena.create<Table>(columns, isApproximate() ? L"Statistics (approximate)" : L"Statistics");
+    }
+
+    /// Every statistic of the report, streamed to writer without building a table
+    void write(ReportWriter& writer) const
+    {
+        writer.writeInteger("approximate", isApproximate());
+        writer.writeInteger("minimum", statistics.getMin());
+        writer.writeInteger("maximum", statistics.getMax());
+        writer.writeInteger("range", statistics.getRange());
+        writer.writeInteger("size", isApproximate() ? std::llround(estimates->size.estimate)
+                                                    : static_cast<long long>(statistics.getSize()));
+        writer.writeInteger("sum", isApproximate() ? std::llround(estimates->sum.estimate) : statistics.getSum());
+        writer.writeReal("mean", statistics.getMean());
+        writer.writeReal("median", statistics.getMedian());
+        writer.writeIntegers("mode", statistics.getMode());
+        writer.writeReal("standard_deviation", statistics.getStandardDeviation());
+        writer.writeReal("variance", statistics.getVariance());
+        writer.writeReal("mid_range", statistics.getMidRange());
+        const auto& quartiles = statistics.getQuartiles();
+        writer.writeReal("q1", quartiles.Q1);
+        writer.writeReal("q2", quartiles.Q2);
+        writer.writeReal("q3", quartiles.Q3);
+        writer.writeReal("interquartile_range", statistics.getIQR());
+        writer.writeIntegers("outliers", statistics.getOutliers());
+        writer.writeReal("sum_of_squares", statistics.getSumOfSquares());
+        writer.writeReal("mean_absolute_deviation", statistics.getMeanAbsoluteDeviation());
+        writer.writeReal("root_mean_square", statistics.getRootMeanSquare());
+        writer.writeReal("standard_error_of_the_mean", statistics.getStdErrorOfMean());
+        writer.writeReal("skewness", statistics.getSkewness());
+        writer.writeReal("kurtosis", statistics.getKurtosis());
+        writer.writeReal("kurtosis_excess", statistics.getKurtosisExcess());
+        writer.writeReal("coefficient_of_variation", statistics.getCoefficientOfVariation());
+        writer.writeReal("relative_standard_deviation", statistics.getRelativeStd());
+        FrequencyEntry entry;
+        for (auto cursor = statistics.getFrequencyCursor(); cursor.next(entry);)
+            writer.writeFrequency(entry.value, entry.frequency, 100 * entry.frequencyPercentage);
+        writer.finish();
+    }
+
+    /// Write the report in format to sink
+    void write(ReportFormat format, OutputSink& sink) const
+    {
+        if (format == ReportFormat::Table)
+        {
+            auto arena = RenderArena();
+            toUITable(arena)->dumpTableTo(sink);
+        }
+        else
+            write(*makeReportWriter(format, sink));
+    }
+
+private:
+    const Statistics<long>& statistics;
+    std::optional<PopulationEstimates> estimates;
+
+    /// Confidence intervals for the rows of the report, empty for rows that are not a single number.
+    MixedColumn* sampleIntervalsToUIColumn(RenderArena& arena) const
+    {
+        std::vector<std::optional<SampleMetric<long>>> rowMetrics {
+            toSampleMetric(&Statistics<long>::getMin),
+            toSampleMetric(&Statistics<long>::getMax),
+            toSampleMetric(&Statistics<long>::getRange),
+            std::nullopt, // Size
+            std::nullopt, // Sum
+            toSampleMetric(&Statistics<long>::getMean),
+            toSampleMetric(&Statistics<long>::getMedian),
+            std::nullopt, // Mode
+            toSampleMetric(&Statistics<long>::getStandardDeviation),
+            toSampleMetric(&Statistics<long>::getVariance),
+            toSampleMetric(&Statistics<long>::getMidRange),
+            std::nullopt, // Quartiles, shown in their own table
+            toSampleMetric(&Statistics<long>::getIQR),
+            std::nullopt, // Outliers
+            toSampleMetric(&Statistics<long>::getSumOfSquares),
+            toSampleMetric(&Statistics<long>::getMeanAbsoluteDeviation),
+            toSampleMetric(&Statistics<long>::getRootMeanSquare),
+            toSampleMetric(&Statistics<long>::getStdErrorOfMean),
+            toSampleMetric(&Statistics<long>::getSkewness),
+            toSampleMetric(&Statistics<long>::getKurtosis),
+            toSampleMetric(&Statistics<long>::getKurtosisExcess),
+            toSampleMetric(&Statistics<long>::getCoefficientOfVariation),
+            toSampleMetric(&Statistics<long>::getRelativeStd),
+            std::nullopt  // Frequency Table
+        };
+        std::vector<SampleMetric<long>> metrics;
+        for (const auto& metric : rowMetrics)
+            if (metric.has_value())
+                metrics.push_back(metric.value());
+        auto intervals = getSampleIntervals(metrics);
+
+        auto intervalColumn = arena.create<MixedColumn>(0, 5, L"Confidence");
+        auto nextInterval = intervals.cbegin();
+        for (std::size_t row = 0; row < rowMetrics.size(); row++)
+        {
+            if (row == 3)
+                intervalColumn->addItems(intervalToString(estimates->size));
+            else if (row == 4)
+                intervalColumn->addItems(intervalToString(estimates->sum));
+            else if (rowMetrics[row].has_value())
+                intervalColumn->addItems(intervalToString(*nextInterval++));
+            else
+                intervalColumn->addItems(std::wstring());
+        }
+        return intervalColumn;
+    }
+};
+
+#endif //PROJ1_STATISTICSREPORT_H
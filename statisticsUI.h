@@ -9,57 +9,68 @@
 #include "common.h"
 #include "input.h"
 #include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <iterator>
+#include <fcntl.h>
 #include "ui/OptionUI.h"
 #include "statistics.h"
+#include "rollingStatistics.h"
+#include "sampling.h"
 #include "ui/MixedColumn.h"
+#include "ui/StreamingColumn.h"
+#include "ui/TypedTable.h"
+#include "ui/RenderArena.h"
+#include "ui/BackgroundWriter.h"
+#include "ui/Job.h"
+#include "reportWriter.h"
+#include "statisticsReport.h"
+#include "preview.h"
 
 using namespace std::placeholders;
 
 class StatsUI : public OptionUI, public Statistics<long>
 {
 public:
-    StatsUI() = default;
+    // Tables whose columns never change are typed, their cells are rendered without virtual calls
+    using MenuTable = TypedTable<Col<const wchar_t*>, Col<const wchar_t*>>;
+
+    StatsUI()
+    {
+        // option Y queries ranges of the values in load order
+        keepLoadOrder(true);
+    }
 
     void showCurrentState() override
     {
-        auto optionColumn1 = new MixedColumn (0, 5,L"");
-        optionColumn1->addItems(
-            L"A> Load data file",
-            L"B> Minimum",
-            L"C> Maximum",
-            L"D> Range",
-            L"E> Size",
-            L"F> Sum",
-            L"G> Mean",
-            L"H> Median",
-            L"I> Frequencies",
-            L"J> Mode",
-            L"K> Standard Deviation",
-            L"L> Variance",
-            L"W> Display result and write to file.",
-            L"0> Return"
-        );
-        auto optionColumn2 = new MixedColumn(0, 5,L"");
-        optionColumn2->addItems(
-            L"M> Mid Range",
-            L"N> Quartiles",
-            L"O> Interquartile Range",
-            L"P> Outliers",
-            L"Q> Sum of Squares",
-            L"R> Mean Absolute Deviation",
-            L"S> Root Mean Square",
-            L"T> Standard Error of the Mean",
-            L"U> Coefficient of Variation",
-            L"V> Relative Standard Deviation"
-        );
-        Table({ optionColumn1, optionColumn2 }, L"3> Descriptive Statistics").dumpTableTo(std::wcout);
+        reportFileWrites();
+        auto arena = RenderArena();
+        auto menu = arena.create<MenuTable>(MenuTable::Columns {}, L"3> Descriptive Statistics");
+        menu->addRow(L"A> Load data file",                      L"M> Mid Range");
+        menu->addRow(L"B> Minimum",                             L"N> Quartiles");
+        menu->addRow(L"C> Maximum",                             L"O> Interquartile Range");
+        menu->addRow(L"D> Range",                               L"P> Outliers");
+        menu->addRow(L"E> Size",                                L"Q> Sum of Squares");
+        menu->addRow(L"F> Sum",                                 L"R> Mean Absolute Deviation");
+        menu->addRow(L"G> Mean",                                L"S> Root Mean Square");
+        menu->addRow(L"H> Median",                              L"T> Standard Error of the Mean");
+        menu->addRow(L"I> Frequencies",                         L"U> Coefficient of Variation");
+        menu->addRow(L"J> Mode",                                L"V> Relative Standard Deviation");
+        menu->addRow(L"K> Standard Deviation",                  L"X> Rolling Statistics");
+        menu->addRow(L"L> Variance",                            L"Y> Range Statistics");
+        menu->addRow(L"W> Display result and write to file.",   L"Z> Histogram");
+        menu->addRow(L"0> Return",                              L"1> Bootstrap Confidence Intervals");
+        menu->addRow(L"",                                       L"2> Load sample of data file");
+        menu->addRow(L"",                                       L"3> Refine sample");
+        menu->addRow(L"",                                       L"4> Enter values");
+        menu->dumpTableTo(std::cout);
     }
 
     void init() override
     {
         this->terminateCharacter = '0';
         choiceCollector = CharParameter ("Option: ",
-                                         [](const char& c){ return c == '0' || (tolower(c) >= 'a' && tolower(c) <= 'w');});
+                                         [](const char& c){ return c == '0' || (c >= '1' && c <= '4') || (tolower(c) >= 'a' && tolower(c) <= 'z');});
 
         auto nonEmptyVector = std::shared_ptr<AbstractPrerequisite>(
             new RequireNonEmptyVector(std::ref(elements), "No elements in array")
@@ -69,220 +80,567 @@ public:
                   std::bind(&StatsUI::loadFileOptionHandler, this, _1),
                   StringParameter("Enter file path: "));
         addOption('b',
-                  statsDisplayAdapter(L"Minimum", std::bind(&Statistics::getMin, this))
+                  statsDisplayAdapter(L"Minimum", &Statistics::getMin)
                   ).require(nonEmptyVector);
         addOption('c',
-                  statsDisplayAdapter(L"Maximum", std::bind(&Statistics::getMax, this))
+                  statsDisplayAdapter(L"Maximum", &Statistics::getMax)
                   ).require(nonEmptyVector);
         addOption('d',
-                  statsDisplayAdapter(L"Range", std::bind(&Statistics::getRange, this))
+                  statsDisplayAdapter(L"Range", &Statistics::getRange)
                   ).require(nonEmptyVector);
         addOption('e',
-                  statsDisplayAdapter(L"Size", std::bind(&Statistics::getSize, this))
+                  populationDisplayAdapter(L"Size", &Statistics::getSize, &StatsUI::estimatePopulationSize)
                   ).require(nonEmptyVector);
         addOption('f',
-                  statsDisplayAdapter(L"Sum", std::bind(&Statistics::getSum, this))
+                  populationDisplayAdapter(L"Sum", &Statistics::getSum, &StatsUI::estimatePopulationSum)
         ).require(nonEmptyVector);
         addOption('g',
-                  statsDisplayAdapter(L"Mean", std::bind(&Statistics::getMean, this))
+                  statsDisplayAdapter(L"Mean", &Statistics::getMean)
         ).require(nonEmptyVector);
         addOption('h',
-                  statsDisplayAdapter(L"Median", std::bind(&Statistics::getMedian, this))
+                  statsDisplayAdapter(L"Median", &Statistics::getMedian)
         ).require(nonEmptyVector);
         addOption('i',
-                  frequencyTableDisplayAdapter(std::bind(&Statistics::getFrequencyTable, this))
+                  std::bind(&StatsUI::frequencyTableOptionHandler, this, _1, _2),
+                  CharParameter("Frequencies: (A)ll in pages, (H)ead, (T)ail, (K) most frequent: ",
+                                [](const char& c){ return std::string("ahtk").find(tolower(c)) != std::string::npos; }),
+                  LongParameter("Enter number of rows (rows per page for A): ", [](const long& n){ return n > 0; })
         ).require(nonEmptyVector);
         addOption('j',
-                  statsDisplayAdapter(L"Mode", std::bind(&Statistics::getSize, this))
+                  statsDisplayAdapter(L"Mode", &Statistics::getMode)
         ).require(nonEmptyVector);
         addOption('k',
-                  statsDisplayAdapter(L"Standard Deviation", std::bind(&Statistics::getStandardDeviation, this))
+                  statsDisplayAdapter(L"Standard Deviation", &Statistics::getStandardDeviation)
         ).require(nonEmptyVector);
         addOption('l',
-                  statsDisplayAdapter(L"Variance", std::bind(&Statistics::getVariance, this))
+                  statsDisplayAdapter(L"Variance", &Statistics::getVariance)
         ).require(nonEmptyVector);
         addOption('m',
-                  statsDisplayAdapter(L"Mid Range", std::bind(&Statistics::getMidRange, this))
+                  statsDisplayAdapter(L"Mid Range", &Statistics::getMidRange)
         ).require(nonEmptyVector);
         addOption('n',
                   quartilesDisplayAdapter(std::bind(&Statistics::getQuartiles, this))
         ).require(nonEmptyVector);
         addOption('o',
-                  statsDisplayAdapter(L"Interquartile Range", std::bind(&Statistics::getIQR, this))
+                  statsDisplayAdapter(L"Interquartile Range", &Statistics::getIQR)
         ).require(nonEmptyVector);
         addOption('p',
-                  statsDisplayAdapter(L"Outliers", std::bind(&Statistics::getOutliers, this))
+                  statsDisplayAdapter(L"Outliers", &Statistics::getOutliers)
         ).require(nonEmptyVector);
         addOption('q',
-                  statsDisplayAdapter(L"Sum of Squares", std::bind(&Statistics::getSumOfSquares, this))
+                  statsDisplayAdapter(L"Sum of Squares", &Statistics::getSumOfSquares)
         ).require(nonEmptyVector);
         addOption('r',
-                  statsDisplayAdapter(L"Mean Absolute Deviation", std::bind(&Statistics::getMeanAbsoluteDeviation, this))
+                  statsDisplayAdapter(L"Mean Absolute Deviation", &Statistics::getMeanAbsoluteDeviation)
         ).require(nonEmptyVector);
         addOption('s',
-                  statsDisplayAdapter(L"Root Mean Square", std::bind(&Statistics::getRootMeanSquare, this))
+                  statsDisplayAdapter(L"Root Mean Square", &Statistics::getRootMeanSquare)
         ).require(nonEmptyVector);
         addOption('t',
-                  statsDisplayAdapter(L"Standard Error of the Mean", std::bind(&Statistics::getStdErrorOfMean, this))
+                  statsDisplayAdapter(L"Standard Error of the Mean", &Statistics::getStdErrorOfMean)
         ).require(nonEmptyVector);
         addOption('u',
-                  statsDisplayAdapter(L"Coefficient of Variation", std::bind(&Statistics::getCoefficientOfVariation, this))
+                  statsDisplayAdapter(L"Coefficient of Variation", &Statistics::getCoefficientOfVariation)
         ).require(nonEmptyVector);
         addOption('v',
-                  statsDisplayAdapter(L"Relative Standard Deviation", std::bind(&Statistics::getRelativeStd, this))
+                  statsDisplayAdapter(L"Relative Standard Deviation", &Statistics::getRelativeStd)
+        ).require(nonEmptyVector);
+        addOption('w',
+                  std::bind(&StatsUI::displayAllResultAndWriteToFile, this, _1),
+                  CharParameter("Report format: (T)able, (C)SV, (J)SON lines, (B)inary: ",
+                                [](const char& c){ return reportFormatFromLetter(c).has_value(); })
+        ).require(nonEmptyVector);
+        addOption('x',
+                  std::bind(&StatsUI::rollingStatisticsOptionHandler, this, _1, _2),
+                  StringParameter("Enter series file path: "),
+                  LongParameter("Enter window size: ", [](const long& n){ return n > 0; }));
+        addOption('y',
+                  std::bind(&StatsUI::rangeStatisticsOptionHandler, this, _1, _2),
+                  LongParameter("Enter first index: ", [](const long& n){ return n >= 0; }),
+                  LongParameter("Enter last index (exclusive): ", [](const long& n){ return n >= 0; })
         ).require(nonEmptyVector);
-        addOption('w', std::bind(&StatsUI::displayAllResultAndWriteToFile, this)
+        addOption('z',
+                  std::bind(&StatsUI::histogramOptionHandler, this, _1, _2),
+                  CharParameter("Bins: (F)ixed width, (L)og scale, (Q)uantile: ",
+                                [](const char& c){ return std::string("flq").find(tolower(c)) != std::string::npos; }),
+                  LongParameter("Enter number of bins: ", [](const long& n){ return n > 0; })
         ).require(nonEmptyVector);
+        addOption('1',
+                  std::bind(&StatsUI::bootstrapOptionHandler, this, _1, _2, _3),
+                  LongParameter("Enter number of resamples: ", [](const long& n){ return n >= 2; }),
+                  DoubleParameter("Enter confidence level (%): ", [](const double& d){ return d > 0 && d < 100; }),
+                  LongParameter("Enter random seed: ")
+        ).require(nonEmptyVector);
+        addOption('2',
+                  std::bind(&StatsUI::loadSampleOptionHandler, this, _1, _2, _3, _4),
+                  StringParameter("Enter file path: "),
+                  CharParameter("Sampling: (R)eservoir while loading, (B)locks of the mapped file: ",
+                                [](const char& c){ return tolower(c) == 'r' || tolower(c) == 'b'; }),
+                  LongParameter("Enter sample size: ", [](const long& n){ return n > 0; }),
+                  LongParameter("Enter time budget in ms (0 for none, block sampling only): ",
+                                [](const long& n){ return n >= 0; }));
+        addOption('3', std::bind(&StatsUI::refineSampleOptionHandler, this)
+        ).require(std::make_shared<RequireValuedOptional<std::optional<SampleState>>>(
+            std::ref(sampleState), "No sample loaded"));
+        addOption('4',
+                  std::bind(&StatsUI::enterValuesOptionHandler, this, _1),
+                  LongVectorParameter("Enter values, end with an empty line: ",
+                                      [](const std::vector<long>& values){ return !values.empty(); }));
     }
 
     void loadFileOptionHandler(std::string&& path)
     {
-        Statistics::loadDataFromFilePath(path);
-        std::wcout << "File opened successfully!" << std::endl;
-        for (auto& e: elements) std::wcout << e << " ";
-        std::wcout << std::endl;
+        auto preview = DataPreview<long>();
+        // a cancelled load keeps the values loaded before, and the sample
+        runJob("Loading " + path, [&](JobControl& job)
+        {
+            Statistics::loadDataFromFilePath(path, [&preview](const std::vector<long>& inFileOrder)
+            {
+                preview.captureSlices(inFileOrder, config::PREVIEW_SLICE_LENGTH);
+            }, [&job](std::size_t bytesRead, std::size_t totalBytes)
+            {
+                job.update(bytesRead, totalBytes);
+            });
+        });
+        sampleState.reset();
+        std::cout << "File opened successfully!" << std::endl;
+        preview.describeSorted(elements, config::PREVIEW_SAMPLE_SIZE, config::PREVIEW_SPARKLINE_WIDTH, config::SAMPLE_SEED);
+        showPreview(preview);
     }
 
-    template <class WideString = std::wstring, typename Func>
-    std::function<void(void)> statsDisplayAdapter(WideString name, Func statsGetter)
+    /// Values typed or piped in at the prompt instead of read from a file
+    void enterValuesOptionHandler(std::vector<long>&& values)
     {
-        return [statsGetter, name] ()
+        auto preview = DataPreview<long>();
+        preview.captureSlices(values, config::PREVIEW_SLICE_LENGTH);
+        Statistics::loadData(std::move(values));
+        sampleState.reset();
+        preview.describeSorted(elements, config::PREVIEW_SAMPLE_SIZE, config::PREVIEW_SPARKLINE_WIDTH, config::SAMPLE_SEED);
+        showPreview(preview);
+    }
+
+    /// A bounded glimpse of the loaded values instead of all of them
+    static void showPreview(const DataPreview<long>& preview)
+    {
+        auto showValues = [](const char* label, const std::vector<long>& values)
         {
-            auto stat = statsGetter();
-            auto nameColumn = new MixedColumn(0, 5, L"", name);
-            auto equalColumn = new MixedColumn(0, 5, L"", L"=");
-            auto statColumn = new MixedColumn(0, 5, L"", stat);
-            Table({nameColumn, equalColumn, statColumn}, L"Result: ").dumpTableTo(std::wcout);
+            std::cout << std::setw(16) << std::left << label << std::right;
+            for (auto& e: values) std::cout << e << " ";
+            std::cout << '\n';
         };
+
+        std::cout << "Loaded " << preview.count << " values." << '\n';
+        if (preview.count == 0)
+            return;
+        if (preview.tail.empty())
+            showValues("Values:", preview.head);
+        else
+        {
+            showValues("First values:", preview.head);
+            showValues("Last values:", preview.tail);
+            showValues("Random sample:", preview.sample);
+        }
+        std::cout << std::setw(16) << std::left << "Distribution:" << std::right
+                  << preview.minimum << " [" << sparkline(preview.distribution.counts) << "] " << preview.maximum
+                  << std::endl;
     }
 
-    template <typename Func>
-    std::function<void(void)> quartilesDisplayAdapter(Func quartilesGetter)
+    /// Statistics over a sliding window, one row per sample of the series (in file order).
+    void rollingStatisticsOptionHandler(std::string&& path, long windowSize)
     {
-        return [quartilesGetter] ()
+        std::ifstream seriesFile(path);
+        if (!seriesFile.is_open())
+            throw UIExcept("Cannot open file");
+
+        auto cell = [](const std::optional<double>& value)
         {
-            Quartiles  quartiles = quartilesGetter();
-            auto nameColumn = new MixedColumn(0, 5, L"", "Q1", "Q2", "Q3");
-            auto equalColumn = new MixedColumn(0, 5, L"");
-            equalColumn->repeatedAddItems(std::vector<std::wstring>(3, L"-->"));
-            auto statsColumn = new MixedColumn(0, 5, L"", quartiles.Q1, quartiles.Q2, quartiles.Q3);
-            Table({nameColumn, equalColumn, statsColumn}, L"Quartiles: ").dumpTableTo(std::wcout);
+            if (value.has_value())
+                return std::string(FormattedNumber::fixed(value.value(), config::FLOAT_NUMBER_DIGITS).view());
+            return std::string("None");
         };
+        auto width = std::setw(config::ROLLING_COLUMN_WIDTH);
+
+        std::cout << width << "Index" << width << "Value" << width << "Mean" << width << "Std Dev"
+                   << width << "Median" << width << "Q1" << width << "Q3" << std::endl;
+        auto rolling = RollingStatistics<long>(windowSize, {0.25, 0.75});
+        rolling.runOver(seriesFile, [&](const RollingStatistics<long>::Step& step)
+        {
+            std::cout << width << step.index << width << step.value
+                       << width << cell(step.mean) << width << cell(std::sqrt(step.variance))
+                       << width << cell(step.median)
+                       << width << cell(step.quantiles.at(0)) << width << cell(step.quantiles.at(1))
+                       << '\n';
+        });
+        std::cout << std::flush;
     }
 
-    template <typename Func>
-    Table* frequencyTableToUITable(Func frequencyTableGetter)
+    /// Statistics over an index range of the elements in load order.
+    void rangeStatisticsOptionHandler(long first, long last)
     {
-        auto freqTable = frequencyTableGetter();
-        std::vector<long> values;
-        std::transform(freqTable.begin(), freqTable.end(), std::back_inserter(values), std::mem_fn(&FrequencyEntry::value));
-        std::vector<long> frequency;
-        std::transform(freqTable.begin(), freqTable.end(), std::back_inserter(frequency), std::mem_fn(&FrequencyEntry::frequency));
-        std::vector<double> frequencyPercentage;
-        std::transform(freqTable.begin(), freqTable.end(), std::back_inserter(frequencyPercentage),
-                       [](const auto& entry){return 100 * std::mem_fn(&FrequencyEntry::frequencyPercentage)(entry);}
-        );
+        auto moments = getRangeMoments(first, last);
+        auto arena = RenderArena();
+        auto nameColumn = arena.create<MixedColumn>(0, 5, L"",
+                                          L"Minimum", L"Maximum", L"Sum", L"Mean", L"Variance", L"Standard Deviation");
+        auto equalColumn = arena.create<MixedColumn>(0, 5, L"", L"=", L"=", L"=", L"=", L"=", L"=");
+        auto statColumn = arena.create<MixedColumn>(0, 5, L"",
+                                          moments.min, moments.max, moments.sum,
+                                          moments.getMean(), moments.getVariance(), moments.getStandardDeviation());
+        arena.create<Table>(Table::ColumnList {nameColumn, equalColumn, statColumn},
+              L"Range [" + std::to_wstring(first) + L", " + std::to_wstring(last) + L"): ")->dumpTableTo(std::cout);
+    }
 
-        auto valueColumn = new MixedColumn (0, 5, L"Values");
-        valueColumn->repeatedAddItems(values);
-        auto freqColumn = new MixedColumn (0, 5, L"Frequency");
-        freqColumn->repeatedAddItems(frequency);
-        auto freqPercentColumn = new MixedColumn (0, 5, L"Percentage");
-        freqPercentColumn->repeatedAddItems(frequencyPercentage);
-        return new Table({valueColumn, freqColumn, freqPercentColumn}, L"", -1, false);
+    void histogramOptionHandler(char schemeChoice, long binCount)
+    {
+        auto scheme = tolower(schemeChoice) == 'l' ? BinningScheme::LogScale
+                    : tolower(schemeChoice) == 'q' ? BinningScheme::Quantile
+                    : BinningScheme::FixedWidth;
+        auto arena = RenderArena();
+        histogramToUITable(arena, getHistogram(scheme, binCount))->dumpTableTo(std::cout);
+    }
+
+    void bootstrapOptionHandler(long resampleCount, double confidencePercent, long seed)
+    {
+        auto result = getBootstrapIntervals(resampleCount, confidencePercent / 100.0, seed);
+        auto arena = RenderArena();
+        auto nameColumn = arena.create<MixedColumn>(0, 5, L"Statistic", L"Mean", L"Median", L"Standard Deviation");
+        auto estimateColumn = arena.create<MixedColumn>(0, 5, L"Estimate",
+                                              result.mean.estimate, result.median.estimate,
+                                              result.standardDeviation.estimate);
+        auto lowerColumn = arena.create<MixedColumn>(0, 5, L"Lower",
+                                           result.mean.lower, result.median.lower,
+                                           result.standardDeviation.lower);
+        auto upperColumn = arena.create<MixedColumn>(0, 5, L"Upper",
+                                           result.mean.upper, result.median.upper,
+                                           result.standardDeviation.upper);
+        std::wostringstream title;
+        title << resampleCount << L" resamples, " << confidencePercent << L"% confidence intervals: ";
+        arena.create<Table>(Table::ColumnList {nameColumn, estimateColumn, lowerColumn, upperColumn}, title.str())
+            ->dumpTableTo(std::cout);
+    }
+
+    Table* histogramToUITable(RenderArena& arena, const Histogram& histogram)
+    {
+        auto lowerColumn = arena.create<MixedColumn>(0, 5, L"From");
+        lowerColumn->repeatedAddItems(std::vector<double>(histogram.edges.cbegin(), std::prev(histogram.edges.cend())));
+        auto upperColumn = arena.create<MixedColumn>(0, 5, L"To");
+        upperColumn->repeatedAddItems(std::vector<double>(std::next(histogram.edges.cbegin()), histogram.edges.cend()));
+        auto countColumn = arena.create<MixedColumn>(0, 5, L"Count");
+        countColumn->repeatedAddItems(histogram.counts);
+        std::vector<double> percentage;
+        long total = histogram.getTotalCount();
+        std::transform(histogram.counts.cbegin(), histogram.counts.cend(), std::back_inserter(percentage),
+                       [total](long count) { return 100.0 * count / total; });
+        auto percentageColumn = arena.create<MixedColumn>(0, 5, L"Percentage");
+        percentageColumn->repeatedAddItems(percentage);
+        return arena.create<Table>(Table::ColumnList {lowerColumn, upperColumn, countColumn, percentageColumn},
+                                   L"Histogram");
+    }
+
+    /// Load a sample instead of the whole file, statistics are then shown with confidence intervals.
+    void loadSampleOptionHandler(std::string&& path, char method, long sampleSize, long timeBudgetMs)
+    {
+        auto state = SampleState {path, static_cast<std::size_t>(sampleSize), std::chrono::milliseconds(timeBudgetMs),
+                                  {}, nullptr};
+        std::vector<long> sample;
+        if (tolower(method) == 'b')
+        {
+            state.blockSampler = std::make_unique<BlockSampler<long>>(path, config::SAMPLE_SEED);
+            state.blockSampler->sampleInto(sample, state.targetSize, state.getDeadline());
+        }
+        else
+        {
+            std::ifstream dataFile(path);
+            if (!dataFile.is_open())
+                throw UIExcept("Cannot open file");
+            auto rng = CounterRng(config::SAMPLE_SEED);
+            reservoirSample(dataFile, state.targetSize, rng, sample, state.population);
+        }
+        if (sample.empty())
+            throw UIExcept("No values could be sampled");
+
+        Statistics::clear();
+        elements = std::move(sample);
+        std::sort(elements.begin(), elements.end());
+        sampleState = std::move(state);
+        reportSampleState();
+    }
+
+    /// Double the sample. Once it covers the whole file the results become exact.
+    void refineSampleOptionHandler()
+    {
+        auto& state = sampleState.value();
+        // whole blocks may have taken the sample past its target
+        state.targetSize = std::max(state.targetSize, elements.size()) * 2;
+        if (state.blockSampler)
+        {
+            std::vector<long> addedValues;
+            state.blockSampler->sampleInto(addedValues, state.targetSize - elements.size(), state.getDeadline());
+            std::sort(addedValues.begin(), addedValues.end());
+            auto middle = elements.insert(elements.end(), addedValues.cbegin(), addedValues.cend());
+            std::inplace_merge(elements.begin(), middle, elements.end());
+            clearCaches();
+        }
+        else
+        {
+            std::ifstream dataFile(state.path);
+            if (!dataFile.is_open())
+                throw UIExcept("Cannot open file");
+            auto rng = CounterRng(config::SAMPLE_SEED);
+            state.population = Moments<long>();
+            reservoirSample(dataFile, state.targetSize, rng, elements, state.population);
+            std::sort(elements.begin(), elements.end());
+            clearCaches();
+        }
+        reportSampleState();
+    }
+
+    void reportSampleState()
+    {
+        auto& state = sampleState.value();
+        if (state.isExact(elements.size()))
+        {
+            loadCoveredFile(std::string(state.path));
+            std::cout << "The sample covers the whole file, which was loaded in file order. Results are exact."
+                      << std::endl;
+            return;
+        }
+        std::cout << "Sampled " << elements.size() << " values";
+        if (state.blockSampler)
+            std::cout << " from " << std::fixed << std::setprecision(config::FLOAT_NUMBER_DIGITS)
+                       << 100.0 * state.blockSampler->getCoverage() << "% of the file";
+        else
+            std::cout << " out of " << state.population.count;
+        std::cout << ". Results are approximate." << std::endl;
+    }
+
+    /** The sample holds every value of the file at path, but sorted, while range queries need
+     *  them in file order. The file is loaded again for them; a cancelled load keeps the sample.
+     */
+    void loadCoveredFile(std::string&& path)
+    {
+        runJob("Loading " + path, [&](JobControl& job)
+        {
+            Statistics::loadDataFromFilePath(path, nullptr, [&job](std::size_t bytesRead, std::size_t totalBytes)
+            {
+                job.update(bytesRead, totalBytes);
+            });
+        });
+        sampleState.reset();
+    }
+
+    bool isApproximate() const
+    {
+        return sampleState.has_value();
+    }
+
+    ConfidenceInterval estimatePopulationSize() const
+    {
+        auto& state = sampleState.value();
+        if (state.blockSampler)
+            return state.blockSampler->estimateCount(config::SAMPLE_CONFIDENCE_LEVEL);
+        double count = state.population.count;
+        return ConfidenceInterval {count, count, count};
+    }
+
+    ConfidenceInterval estimatePopulationSum() const
+    {
+        auto& state = sampleState.value();
+        if (state.blockSampler)
+            return state.blockSampler->estimateSum(config::SAMPLE_CONFIDENCE_LEVEL);
+        double sum = state.population.sum;
+        return ConfidenceInterval {sum, sum, sum};
+    }
+
+    /// The report of the loaded values, with the estimates of the file when they are a sample
+    StatisticsReport report() const
+    {
+        if (!isApproximate())
+            return StatisticsReport(*this);
+        return StatisticsReport(*this, StatisticsReport::PopulationEstimates {estimatePopulationSize(),
+                                                                              estimatePopulationSum()});
+    }
+
+    template <class WideString = std::wstring, typename Getter>
+    std::function<void(void)> statsDisplayAdapter(WideString name, Getter statsGetter)
+    {
+        return [this, statsGetter, name] ()
+        {
+            auto stat = std::invoke(statsGetter, static_cast<const Statistics&>(*this));
+            auto arena = RenderArena();
+            auto nameColumn = arena.create<MixedColumn>(0, 5, L"", name);
+            auto equalColumn = arena.create<MixedColumn>(0, 5, L"", L"=");
+            auto statColumn = arena.create<MixedColumn>(0, 5, L"", stat);
+            auto columns = std::pmr::vector<AbstractColumn*>({nameColumn, equalColumn, statColumn}, arena.getAllocator());
+            auto metric = StatisticsReport::toSampleMetric(statsGetter);
+            if (isApproximate() && metric.has_value())
+                columns.push_back(arena.create<MixedColumn>(
+                    0, 5, L"", StatisticsReport::intervalToString(report().getSampleIntervals({metric.value()}).front())));
+            arena.create<Table>(columns, L"Result: ")->dumpTableTo(std::cout);
+        };
+    }
+
+    /// Statistics that describe the whole file (size, sum) are estimated from the sample instead of bootstrapped.
+    template <class WideString = std::wstring, typename Getter, typename Estimator>
+    std::function<void(void)> populationDisplayAdapter(WideString name, Getter statsGetter, Estimator estimator)
+    {
+        return [this, statsGetter, estimator, name] ()
+        {
+            if (!isApproximate())
+                return statsDisplayAdapter(name, statsGetter)();
+
+            auto estimate = std::invoke(estimator, this);
+            auto arena = RenderArena();
+            auto nameColumn = arena.create<MixedColumn>(0, 5, L"", name);
+            auto equalColumn = arena.create<MixedColumn>(0, 5, L"", L"=");
+            auto statColumn = arena.create<MixedColumn>(0, 5, L"", std::llround(estimate.estimate));
+            auto intervalColumn = arena.create<MixedColumn>(0, 5, L"", StatisticsReport::intervalToString(estimate));
+            arena.create<Table>(Table::ColumnList {nameColumn, equalColumn, statColumn, intervalColumn}, L"Result: ")
+                ->dumpTableTo(std::cout);
+        };
     }
 
     template <typename Func>
-    std::function<void(void)> frequencyTableDisplayAdapter(Func frequencyTableGetter)
+    std::function<void(void)> quartilesDisplayAdapter(Func quartilesGetter)
     {
-        return [this, frequencyTableGetter] ()
+        return [this, quartilesGetter] ()
         {
-            auto table = frequencyTableToUITable(frequencyTableGetter);
-            table->dumpTableTo(std::wcout);
-            delete table;
+            Quartiles quartiles = quartilesGetter();
+            auto arena = RenderArena();
+            report().quartilesToUITable(arena, quartiles, L"Quartiles: ")->dumpTableTo(std::cout);
         };
     }
 
-    void displayAllResultAndWriteToFile()
+    void dumpFrequencyTable(const FrequencyCursor& cursor, std::size_t count, std::wstring_view title)
     {
-        auto statisticNameColumn = new MixedColumn (0, 5,L"Concept");
-        statisticNameColumn->addItems(
-        L"Minimum",
-        L"Maximum",
-        L"Range",
-        L"Size",
-        L"Sum",
-        L"Mean",
-        L"Median",
-        L"Mode",
-        L"Standard Deviation",
-        L"Variance",
-        L"Mid Range",
-        L"Quartiles",
-        L"Interquartile Range",
-        L"Outliers",
-        L"Sum of Squares",
-        L"Mean Absolute Deviation",
-        L"Root Mean Square",
-        L"Standard Error of the Mean",
-        L"Skewness",
-        L"Kurtosis",
-        L"Kurtosis Excess",
-        L"Coefficient of Variation",
-        L"Relative Standard Deviation",
-        L"Frequency Table");
-
-        auto quartiles = getQuartiles();
-        auto quartileNames = new MixedColumn(0, 5, L"", "Q1", "Q2", "Q3");
-        auto arrowColumn = new MixedColumn(0, 5, L"");
-        arrowColumn->repeatedAddItems(std::vector<const char*>(3, "-->"));
-        auto quartileValues = new MixedColumn(0, 5, L"", quartiles.Q1, quartiles.Q2, quartiles.Q3);
-        auto* quartileTable = new Table({quartileNames, arrowColumn, quartileValues}, L"", -1, false);
-
-        auto statisticValueColumn = new MixedColumn(0, 5, L"Values");
-        statisticValueColumn->addItems(
-            getMin(),
-            getMax(),
-            getRange(),
-            getSize(),
-            getSum(),
-            getMean(),
-            getMedian(),
-            getMode(),
-            getStandardDeviation(),
-            getVariance(),
-            getMidRange(),
-            quartileTable,
-            getIQR(),
-            getOutliers(),
-            getSumOfSquares(),
-            getMeanAbsoluteDeviation(),
-            getRootMeanSquare(),
-            getStdErrorOfMean(),
-            getSkewness(),
-            getKurtosis(),
-            getKurtosisExcess(),
-            getCoefficientOfVariation(),
-            to_wstring(getRelativeStd()) + L"%",
-            frequencyTableToUITable(std::bind(&Statistics::getFrequencyTable, this))
-        );
+        auto arena = RenderArena();
+        StatisticsReport::frequencyTableToUITable(arena, StatisticsReport::frequencyRows(arena, cursor, count), title)
+            ->dumpTableTo(std::cout);
+    }
+
+    void dumpFrequencyTable(std::vector<FrequencyEntry>&& entries, std::wstring_view title)
+    {
+        auto arena = RenderArena();
+        auto rows = arena.create<VectorRowStream<FrequencyEntry>>(std::move(entries));
+        StatisticsReport::frequencyTableToUITable(arena, *rows, title)->dumpTableTo(std::cout);
+    }
 
-        auto equalColumn = new MixedColumn(0, 2, L"");
-        equalColumn->repeatedAddItems(std::vector<char>(24, '='));
+    void frequencyTableOptionHandler(char view, long rowCount)
+    {
+        auto count = static_cast<std::size_t>(rowCount);
+        auto distinctCount = getDistinctCount();
+        auto ofDistinct = L" of " + std::to_wstring(distinctCount) + L" distinct values";
+        switch (tolower(view))
+        {
+            case 'h':
+                dumpFrequencyTable(getFrequencyCursor(), count,
+                                   L"Smallest " + std::to_wstring(std::min(count, distinctCount)) + ofDistinct);
+                break;
+            case 't':
+                dumpFrequencyTable(getLastFrequencies(count), count,
+                                   L"Largest " + std::to_wstring(std::min(count, distinctCount)) + ofDistinct);
+                break;
+            case 'k':
+                dumpFrequencyTable(getMostFrequent(count),
+                                   L"Most frequent " + std::to_wstring(std::min(count, distinctCount)) + ofDistinct);
+                break;
+            default:
+            {
+                // each page is laid out and written before the next one is computed
+                auto pageCount = (distinctCount + count - 1) / count;
+                auto cursor = getFrequencyCursor();
+                for (std::size_t page = 1; !cursor.isExhausted(); page++, cursor.skip(count))
+                    dumpFrequencyTable(cursor, count,
+                                       L"Page " + std::to_wstring(page) + L" of " + std::to_wstring(pageCount));
+            }
+        }
+    }
+
+    /** The report is rendered once into memory. The table is shown from there before it is
+     *  written, the other formats are only written to the file. The file is written on the
+     *  I/O thread, which is reported back before the menu is shown again.
+     */
+    void displayAllResultAndWriteToFile(char formatLetter)
+    {
+        auto format = reportFormatFromLetter(formatLetter).value();
+        auto rendered = std::make_shared<MemorySink>();
+        runJob("Rendering report", [&](JobControl& job)
+        {
+            auto progress = ProgressSink(job, *rendered);
+            report().write(format, progress);
+        });
+        if (format == ReportFormat::Table)
+        {
+            auto terminal = StreamSink(std::cout);
+            rendered->writeTo(terminal);
+        }
 
-        auto table = Table({statisticNameColumn, equalColumn, statisticValueColumn}, L"Statistics");
-        table.dumpTableTo(std::wcout);
+        auto filePath = collect(StringParameter ("Enter file path: "));
+        int fd = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        while (fd < 0)
+        {
+            // a script cannot be asked again
+            if (script != nullptr)
+                throw UIExcept("Cannot open file " + filePath);
+            std::cout << "ERROR: Cannot open file. Try again." << endl;
+            filePath = collect(StringParameter ("Enter file path: "));
+            fd = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        }
+        fileWriter.submit(std::move(filePath), fd, std::move(rendered));
+        std::cout << "Writing summary to file in the background." << std::endl;
+    }
 
-        auto filePath = StringParameter ("Enter file path: ").collectParam();
-        auto outFile = wofstream (filePath);
-        while (!outFile.is_open())
+    /// Wait for the files that are still being written and report them, false when one could not be written
+    bool finishFileWrites()
+    {
+        fileWriter.waitIdle();
+        return reportFileWrites();
+    }
+
+protected:
+    struct SampleState
+    {
+        std::string path;
+        std::size_t targetSize;
+        std::chrono::milliseconds timeBudget;
+        // moments of every value read, only used by reservoir sampling
+        Moments<long> population;
+        // only set for block sampling, kept to continue sampling on refine
+        std::unique_ptr<BlockSampler<long>> blockSampler;
+
+        SamplingDeadline getDeadline() const
+        {
+            if (timeBudget.count() == 0)
+                return std::nullopt;
+            return std::chrono::steady_clock::now() + timeBudget;
+        }
+
+        bool isExact(std::size_t sampleSize) const
+        {
+            return blockSampler ? blockSampler->isExhausted() : sampleSize == population.count;
+        }
+    };
+
+    // set while the loaded elements are a sample of a file
+    std::optional<SampleState> sampleState;
+
+    BackgroundWriter fileWriter;
+
+    /// Files written since the last report, false when one could not be written
+    bool reportFileWrites()
+    {
+        bool succeeded = true;
+        for (const auto& completion : fileWriter.takeCompleted())
         {
-            std::wcout << L"ERROR: Cannot open file. Try again." << endl;
-            filePath = StringParameter ("Enter file path: ").collectParam();
-            outFile = wofstream (filePath);
+            if (completion.error.has_value())
+            {
+                std::cout << "ERROR: " << completion.error.value() << " to " << completion.path << std::endl;
+                succeeded = false;
+            }
+            else
+                std::cout << "Summary was written to " << completion.path
+                          << " (" << completion.bytes << " bytes)." << std::endl;
         }
-        table.dumpTableTo(outFile);
-        std::wcout << L"Summary was written to file." << std::endl;
+        return succeeded;
     }
 };
 
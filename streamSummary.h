@@ -0,0 +1,157 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_STREAMSUMMARY_H
+#define PROJ1_STREAMSUMMARY_H
+
+#include <optional>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "moments.h"
+#include "quantileSketch.h"
+#include "heavyHitters.h"
+#include "ui/RenderArena.h"
+#include "ui/TypedTable.h"
+#include "ui/OutputSink.h"
+#include "ui/configuration.h"
+#include "reportWriter.h"
+
+/** Statistics of a stream that is read once, updated value by value in bounded memory:
+ *  exact moments, approximate quantiles and the most frequent values.
+ */
+template <typename T>
+struct StreamSummary
+{
+    Moments<T> moments;
+    QuantileSketch<T> quantiles {config::SKETCH_K, config::SAMPLE_SEED};
+    HeavyHitters<T> frequent {config::HEAVY_HITTERS_CAPACITY};
+
+    void add(const T& value)
+    {
+        moments.add(value);
+        quantiles.add(value);
+        frequent.add(value);
+    }
+
+    /// Add the summary of another part of the stream
+    void merge(const StreamSummary& other)
+    {
+        moments.merge(other.moments);
+        quantiles.merge(other.quantiles);
+        frequent.merge(other.frequent);
+    }
+
+    std::size_t getCount() const
+    {
+        return moments.count;
+    }
+};
+
+/// The summary as three tables: moments, quantiles and the most frequent values
+template <typename T>
+void writeStreamSummary(const StreamSummary<T>& summary, std::wstring_view title, OutputSink& sink)
+{
+    using MomentsTable = TypedTable<Col<std::size_t>, Col<std::optional<T>>, Col<std::optional<T>>,
+                                    Col<std::optional<double>>, Col<std::optional<double>>>;
+    using QuantilesTable = TypedTable<Col<std::optional<double>>, Col<std::optional<double>>, Col<std::optional<double>>,
+                                      Col<std::optional<double>>, Col<std::optional<double>>>;
+    using FrequentTable = TypedTable<Col<T>, Col<std::size_t>, Col<std::size_t>>;
+    auto arena = RenderArena();
+
+    const auto& moments = summary.moments;
+    auto whenCounted = [&moments](auto value)
+    {
+        return moments.count > 0 ? std::make_optional(value) : std::nullopt;
+    };
+    auto momentsTable = arena.create<MomentsTable>(
+        typename MomentsTable::Columns {{L"Count"}, {L"Minimum"}, {L"Maximum"}, {L"Mean"}, {L"Std Dev"}}, title);
+    momentsTable->addRow(moments.count, whenCounted(moments.min), whenCounted(moments.max),
+                         whenCounted(moments.mean), whenCounted(moments.getStandardDeviation()));
+
+    const auto& quantiles = summary.quantiles;
+    auto quantilesTable = arena.create<QuantilesTable>(
+        typename QuantilesTable::Columns {{L"Q1"}, {L"Median"}, {L"Q3"}, {L"P90"}, {L"P99"}},
+        quantiles.isExact() ? L"Quantiles" : L"Quantiles (approximate)");
+    quantilesTable->addRow(quantiles.getQuantile(0.25), quantiles.getQuantile(0.5), quantiles.getQuantile(0.75),
+                           quantiles.getQuantile(0.9), quantiles.getQuantile(0.99));
+
+    auto frequentTable = arena.create<FrequentTable>(
+        typename FrequentTable::Columns {{L"Value"}, {L"Frequency"}, {L"Error"}},
+        summary.frequent.isExact() ? L"Most frequent" : L"Most frequent (approximate)");
+    for (const auto& entry : summary.frequent.getMostFrequent(config::WATCH_TOP_VALUES))
+        frequentTable->addRow(entry.value, entry.count, entry.error);
+
+    momentsTable->dumpTableTo(sink);
+    quantilesTable->dumpTableTo(sink);
+    frequentTable->dumpTableTo(sink);
+}
+
+/** The statistics of the standard report that a summary holds, under the same names. They are
+ *  exact from the moments; the median and the quartiles come from the quantile sketch and the
+ *  mode and the frequency table from the most frequent values, which may make them approximate.
+ *  Outliers and the mean absolute deviation need every value and are missing.
+ */
+inline void writeStreamSummaryReport(const StreamSummary<long>& summary, ReportWriter& writer)
+{
+    const auto& moments = summary.moments;
+    double n = moments.count;
+    double standardDeviation = moments.getStandardDeviation();
+    auto q1 = summary.quantiles.getQuantile(0.25);
+    auto median = summary.quantiles.getQuantile(0.5);
+    auto q3 = summary.quantiles.getQuantile(0.75);
+    auto mostFrequent = summary.frequent.getMostFrequent(summary.frequent.getCapacity());
+
+    writer.writeInteger("approximate", !summary.quantiles.isExact() || !summary.frequent.isExact());
+    writer.writeInteger("minimum", moments.min);
+    writer.writeInteger("maximum", moments.max);
+    writer.writeInteger("range", moments.max - moments.min);
+    writer.writeInteger("size", static_cast<long long>(moments.count));
+    writer.writeInteger("sum", moments.sum);
+    writer.writeReal("mean", moments.mean);
+    writer.writeReal("median", median);
+    std::vector<long> modes;
+    for (const auto& entry : mostFrequent)
+        if (entry.count == mostFrequent.front().count)
+            modes.push_back(entry.value);
+    std::sort(modes.begin(), modes.end());
+    writer.writeIntegers("mode", modes);
+    writer.writeReal("standard_deviation", standardDeviation);
+    writer.writeReal("variance", moments.getVariance());
+    writer.writeReal("mid_range", (moments.max + moments.min) / 2.0);
+    writer.writeReal("q1", q1);
+    writer.writeReal("q2", median);
+    writer.writeReal("q3", q3);
+    writer.writeReal("interquartile_range", q1.has_value() ? std::make_optional(q3.value() - q1.value()) : std::nullopt);
+    writer.writeMissing("outliers");
+    writer.writeReal("sum_of_squares", moments.m2);
+    writer.writeMissing("mean_absolute_deviation");
+    writer.writeReal("root_mean_square", std::sqrt((moments.m2 + n * moments.mean * moments.mean) / n));
+    writer.writeReal("standard_error_of_the_mean", standardDeviation / std::sqrt(n));
+    writer.writeReal("skewness", moments.m3 / (n * std::pow(standardDeviation, 3)));
+    double kurtosis = n * (n + 1) / ((n - 1) * (n - 2) * (n - 3)) * moments.m4 / std::pow(standardDeviation, 4);
+    writer.writeReal("kurtosis", kurtosis);
+    writer.writeReal("kurtosis_excess", kurtosis - 3 * (n - 1) * (n - 1) / ((n - 2) * (n - 3)));
+    writer.writeReal("coefficient_of_variation", standardDeviation / moments.mean);
+    writer.writeReal("relative_standard_deviation", 100.0 * standardDeviation / moments.mean);
+    // in increasing order of value like the full frequency table, but only of the values kept
+    std::sort(mostFrequent.begin(), mostFrequent.end(),
+              [](const auto& a, const auto& b) { return a.value < b.value; });
+    for (const auto& entry : mostFrequent)
+        writer.writeFrequency(entry.value, static_cast<long>(entry.count), 100.0 * entry.count / n);
+    writer.finish();
+}
+
+/// The tables of writeStreamSummary, or the standard report in the other formats
+inline void writeStreamSummary(const StreamSummary<long>& summary, std::wstring_view title,
+                               ReportFormat format, OutputSink& sink)
+{
+    if (format == ReportFormat::Table)
+        writeStreamSummary(summary, title, sink);
+    else
+        writeStreamSummaryReport(summary, *makeReportWriter(format, sink));
+}
+
+#endif //PROJ1_STREAMSUMMARY_H
@@ -0,0 +1,213 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_SUMMARYENCODING_H
+#define PROJ1_SUMMARYENCODING_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "streamSummary.h"
+#include "ui/UIExcept.h"
+#include "ui/configuration.h"
+
+namespace summary_encoding_detail
+{
+    // more levels than a sketch of 2^64 values has
+    constexpr std::uint64_t MAX_SKETCH_LEVELS = 64;
+    // far above the sizes summaries are made with; larger ones are rejected before room is made for them
+    constexpr std::uint64_t MAX_SKETCH_K = 1 << 16;
+    constexpr std::uint64_t MAX_FREQUENT_CAPACITY = 1 << 20;
+
+    /// Little endian numbers appended to bytes, as the binary report writes them
+    class Encoder
+    {
+    public:
+        explicit Encoder(std::string& _bytes) : bytes {_bytes} {}
+
+        void appendUint64(std::uint64_t value)
+        {
+            char encoded[8];
+            for (char& byte : encoded)
+            {
+                byte = static_cast<char>(value & 0xFF);
+                value >>= 8;
+            }
+            bytes.append(encoded, sizeof(encoded));
+        }
+
+        void appendReal(double value)
+        {
+            std::uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            appendUint64(bits);
+        }
+
+        template <typename T>
+        void appendValue(const T& value)
+        {
+            static_assert(std::is_arithmetic_v<T>, "summaries hold numbers");
+            if constexpr (std::is_floating_point_v<T>)
+                appendReal(value);
+            else
+                appendUint64(static_cast<std::uint64_t>(static_cast<std::int64_t>(value)));
+        }
+
+    private:
+        std::string& bytes;
+    };
+
+    /// Reads what an Encoder wrote, throws when the bytes end too early
+    class Decoder
+    {
+    public:
+        explicit Decoder(std::string_view _bytes) : bytes {_bytes} {}
+
+        std::uint64_t readUint64()
+        {
+            if (bytes.size() - position < 8)
+                throw UIExcept("Summary is truncated");
+            std::uint64_t value = 0;
+            for (int i = 7; i >= 0; i--)
+                value = (value << 8) | static_cast<unsigned char>(bytes[position + i]);
+            position += 8;
+            return value;
+        }
+
+        double readReal()
+        {
+            std::uint64_t bits = readUint64();
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        template <typename T>
+        T readValue()
+        {
+            if constexpr (std::is_floating_point_v<T>)
+                return static_cast<T>(readReal());
+            else
+                return static_cast<T>(static_cast<std::int64_t>(readUint64()));
+        }
+
+        /// A count of items of itemBytes each that are still to be read, checked before making room for them
+        std::uint64_t readCount(std::size_t itemBytes)
+        {
+            std::uint64_t count = readUint64();
+            if (count > (bytes.size() - position) / itemBytes)
+                throw UIExcept("Summary is truncated");
+            return count;
+        }
+
+        bool isAtEnd() const
+        {
+            return position == bytes.size();
+        }
+
+    private:
+        std::string_view bytes;
+        std::size_t position = 0;
+    };
+}
+
+/** Append summary to bytes: its moments, the levels of its quantile sketch and the entries of
+ *  its most frequent values, as 8 byte little endian numbers.
+ */
+template <typename T>
+void encodeSummary(const StreamSummary<T>& summary, std::string& bytes)
+{
+    auto encoder = summary_encoding_detail::Encoder(bytes);
+    const auto& moments = summary.moments;
+    encoder.appendUint64(moments.count);
+    encoder.appendValue(moments.sum);
+    encoder.appendValue(moments.min);
+    encoder.appendValue(moments.max);
+    encoder.appendReal(moments.mean);
+    encoder.appendReal(moments.m2);
+    encoder.appendReal(moments.m3);
+    encoder.appendReal(moments.m4);
+
+    const auto& levels = summary.quantiles.getLevels();
+    encoder.appendUint64(summary.quantiles.getK());
+    encoder.appendUint64(levels.size());
+    for (const auto& level : levels)
+    {
+        encoder.appendUint64(level.size());
+        for (const auto& value : level)
+            encoder.appendValue(value);
+    }
+
+    const auto& frequent = summary.frequent;
+    auto entries = frequent.getMostFrequent(frequent.getCapacity());
+    encoder.appendUint64(frequent.getCapacity());
+    encoder.appendUint64(frequent.isExact() ? 1 : 0);
+    encoder.appendUint64(entries.size());
+    for (const auto& entry : entries)
+    {
+        encoder.appendValue(entry.value);
+        encoder.appendUint64(entry.count);
+        encoder.appendUint64(entry.error);
+    }
+}
+
+/// The summary encoded in bytes by encodeSummary, throws when they are not one
+template <typename T>
+StreamSummary<T> decodeSummary(std::string_view bytes)
+{
+    using namespace summary_encoding_detail;
+    auto decoder = Decoder(bytes);
+    auto summary = StreamSummary<T>();
+    auto& moments = summary.moments;
+    moments.count = decoder.readUint64();
+    moments.sum = decoder.readValue<T>();
+    moments.min = decoder.readValue<T>();
+    moments.max = decoder.readValue<T>();
+    moments.mean = decoder.readReal();
+    moments.m2 = decoder.readReal();
+    moments.m3 = decoder.readReal();
+    moments.m4 = decoder.readReal();
+
+    std::uint64_t k = decoder.readUint64();
+    if (k > MAX_SKETCH_K)
+        throw UIExcept("Summary is not valid: sketch size " + std::to_string(k) + " is too large");
+    std::uint64_t levelCount = decoder.readCount(8);
+    if (levelCount > MAX_SKETCH_LEVELS)
+        throw UIExcept("Summary is not valid: too many sketch levels");
+    std::vector<std::vector<T>> levels(levelCount);
+    for (auto& level : levels)
+    {
+        level.resize(decoder.readCount(8));
+        for (auto& value : level)
+            value = decoder.readValue<T>();
+    }
+    summary.quantiles = QuantileSketch<T>(k, config::SAMPLE_SEED, std::move(levels));
+    if (summary.quantiles.getCount() != moments.count)
+        throw UIExcept("Summary is not valid: the sketch does not count every value");
+
+    std::uint64_t capacity = decoder.readUint64();
+    if (capacity > MAX_FREQUENT_CAPACITY)
+        throw UIExcept("Summary is not valid: capacity " + std::to_string(capacity) + " is too large");
+    bool exact = decoder.readUint64() != 0;
+    std::uint64_t entryCount = decoder.readCount(24);
+    if (entryCount > capacity)
+        throw UIExcept("Summary is not valid: more frequent values than its capacity");
+    std::vector<typename HeavyHitters<T>::Entry> entries(entryCount);
+    for (auto& entry : entries)
+    {
+        entry.value = decoder.readValue<T>();
+        entry.count = decoder.readUint64();
+        entry.error = decoder.readUint64();
+    }
+    summary.frequent = HeavyHitters<T>(capacity, entries, exact);
+
+    if (!decoder.isAtEnd())
+        throw UIExcept("Summary is not valid: bytes after its end");
+    return summary;
+}
+
+#endif //PROJ1_SUMMARYENCODING_H
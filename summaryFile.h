@@ -0,0 +1,148 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_SUMMARYFILE_H
+#define PROJ1_SUMMARYFILE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "streamSummary.h"
+#include "summaryEncoding.h"
+#include "ui/UIExcept.h"
+
+/** Summaries saved to files, to combine the statistics of data sets that are never brought
+ *  together, such as the data of several hosts. Merging summaries gives the summary of all
+ *  their values; averaging the statistics of each does not.
+ *
+ *  A summary file starts with the 4 bytes "SUMM", a version byte (1) and a byte for the type
+ *  of the values, 'i' for 64 bit integers or 'f' for binary64. The summary follows as
+ *  encodeSummary writes it, every number 8 bytes little endian:
+ *      moments     uint64 count, value sum, value minimum, value maximum,
+ *                  binary64 mean, m2, m3, m4 (sums of the powers of the deviations)
+ *      quantiles   uint64 k, uint64 level count, then for each level uint64 size and its values
+ *      frequent    uint64 capacity, uint64 exact (1) or not (0), uint64 entry count,
+ *                  then for each entry the value, uint64 count and uint64 error
+ *  A reader refuses a version it does not know.
+ */
+namespace summary_file_detail
+{
+    constexpr std::string_view MAGIC = "SUMM";
+    constexpr char VERSION = 1;
+
+    template <typename T>
+    constexpr char typeTag()
+    {
+        return std::is_floating_point_v<T> ? 'f' : 'i';
+    }
+}
+
+template <typename T>
+std::string serializeSummary(const StreamSummary<T>& summary)
+{
+    using namespace summary_file_detail;
+    auto bytes = std::string(MAGIC);
+    bytes.push_back(VERSION);
+    bytes.push_back(typeTag<T>());
+    encodeSummary(summary, bytes);
+    return bytes;
+}
+
+/// The summary serialized in bytes, throws when they are not one of values of type T
+template <typename T>
+StreamSummary<T> deserializeSummary(std::string_view bytes)
+{
+    using namespace summary_file_detail;
+    if (bytes.size() < MAGIC.size() + 2 || bytes.substr(0, MAGIC.size()) != MAGIC)
+        throw UIExcept("Not a summary file");
+    char version = bytes[MAGIC.size()];
+    if (version != VERSION)
+        throw UIExcept("Summary file version " + std::to_string(static_cast<int>(version)) + " is not supported");
+    if (bytes[MAGIC.size() + 1] != typeTag<T>())
+        throw UIExcept("Summary file holds values of another type");
+    return decodeSummary<T>(bytes.substr(MAGIC.size() + 2));
+}
+
+/// Save summary at path. It is written next to path first, so a reader never sees half of it.
+template <typename T>
+void saveSummary(const StreamSummary<T>& summary, const std::string& path)
+{
+    auto bytes = serializeSummary(summary);
+    auto partial = path + ".partial";
+    int fd = ::open(partial.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        throw UIExcept("Cannot open file " + partial);
+    std::string_view rest = bytes;
+    while (!rest.empty())
+    {
+        ssize_t written = ::write(fd, rest.data(), rest.size());
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+        {
+            ::close(fd);
+            ::unlink(partial.c_str());
+            throw UIExcept("Cannot write file " + partial + ": " + std::strerror(errno));
+        }
+        rest.remove_prefix(written);
+    }
+    if (::close(fd) != 0 || std::rename(partial.c_str(), path.c_str()) != 0)
+    {
+        ::unlink(partial.c_str());
+        throw UIExcept("Cannot write file " + path + ": " + std::strerror(errno));
+    }
+}
+
+template <typename T>
+StreamSummary<T> loadSummary(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw UIExcept("Cannot open file " + path);
+    struct stat status {};
+    std::string bytes;
+    if (::fstat(fd, &status) == 0)
+        bytes.reserve(status.st_size);
+    char buffer[1 << 16];
+    ssize_t count;
+    while ((count = ::read(fd, buffer, sizeof(buffer))) != 0)
+    {
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+        {
+            ::close(fd);
+            throw UIExcept("Cannot read file " + path + ": " + std::strerror(errno));
+        }
+        bytes.append(buffer, count);
+    }
+    ::close(fd);
+    try
+    {
+        return deserializeSummary<T>(bytes);
+    }
+    catch (UIExcept& e)
+    {
+        throw UIExcept(path + ": " + e.what());
+    }
+}
+
+/// The summary of the values of all the summaries saved at paths
+template <typename T>
+StreamSummary<T> mergeSummaryFiles(const std::vector<std::string>& paths)
+{
+    auto merged = StreamSummary<T>();
+    for (const auto& path : paths)
+        merged.merge(loadSummary<T>(path));
+    return merged;
+}
+
+#endif //PROJ1_SUMMARYFILE_H
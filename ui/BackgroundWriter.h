@@ -0,0 +1,131 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_BACKGROUNDWRITER_H
+#define PROJ1_BACKGROUNDWRITER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+#include "OutputSink.h"
+#include "UIExcept.h"
+
+/** Writes rendered text to files on its own I/O thread, one file after the other, so the
+ *  interactive loop does not wait for the disk. The thread is started by the first write.
+ *
+ *  The UI collects finished writes with takeCompleted() between options. Destroying the
+ *  writer waits for the writes that were submitted.
+ */
+class BackgroundWriter
+{
+public:
+    struct Completion
+    {
+        std::string path;
+        std::size_t bytes;
+        // set when the file could not be written completely
+        std::optional<std::string> error;
+    };
+
+    BackgroundWriter() = default;
+
+    BackgroundWriter(const BackgroundWriter&) = delete;
+    BackgroundWriter& operator=(const BackgroundWriter&) = delete;
+
+    ~BackgroundWriter()
+    {
+        {
+            auto lock = std::lock_guard<std::mutex>(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        if (worker.joinable())
+            worker.join();
+    }
+
+    /// Write text to the open file descriptor fd and close it. path only names the file in the completion.
+    void submit(std::string path, int fd, std::shared_ptr<const MemorySink> text)
+    {
+        {
+            auto lock = std::lock_guard<std::mutex>(mutex);
+            jobs.push_back(Job {std::move(path), fd, std::move(text)});
+            if (!worker.joinable())
+                worker = std::thread(&BackgroundWriter::run, this);
+        }
+        wake.notify_one();
+    }
+
+    /// Writes finished since the last call, in the order they were submitted
+    std::vector<Completion> takeCompleted()
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        return std::exchange(completed, {});
+    }
+
+    /// Block until every submitted write is finished
+    void waitIdle()
+    {
+        auto lock = std::unique_lock<std::mutex>(mutex);
+        idle.wait(lock, [this] { return jobs.empty() && !writing; });
+    }
+
+private:
+    struct Job
+    {
+        std::string path;
+        int fd;
+        std::shared_ptr<const MemorySink> text;
+    };
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::deque<Job> jobs;
+    std::vector<Completion> completed;
+    bool writing = false;
+    bool stopping = false;
+    std::thread worker;
+
+    void run()
+    {
+        auto lock = std::unique_lock<std::mutex>(mutex);
+        while (true)
+        {
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+                return;
+
+            auto job = std::move(jobs.front());
+            jobs.pop_front();
+            writing = true;
+            lock.unlock();
+
+            auto completion = Completion {job.path, job.text->getSize(), std::nullopt};
+            try
+            {
+                auto file = FileDescriptorSink(job.fd, true);
+                job.text->writeTo(file);
+            }
+            catch (UIExcept& e)
+            {
+                completion.error = e.what();
+            }
+            // the text is released on this thread, before the next file is written
+            job.text.reset();
+
+            lock.lock();
+            completed.push_back(std::move(completion));
+            writing = false;
+            idle.notify_all();
+        }
+    }
+};
+
+#endif //PROJ1_BACKGROUNDWRITER_H
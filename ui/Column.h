@@ -7,7 +7,20 @@
 
 #include <iostream>
 #include <iomanip>
+#include <type_traits>
 #include "configuration.h"
+#include "RenderBuffer.h"
+#include "NumberFormat.h"
+
+/// Numbers are shown in fixed notation with config::FLOAT_NUMBER_DIGITS digits when they are floating point
+template <typename T>
+FormattedNumber formatColumnNumber(const T& value)
+{
+    if constexpr (std::is_floating_point<T>::value)
+        return FormattedNumber::fixed(value, config::FLOAT_NUMBER_DIGITS);
+    else
+        return FormattedNumber::streamed(value);
+}
 
 class AbstractColumn
 {
@@ -17,7 +30,7 @@ public:
 
     virtual const int getColumnWidth() const = 0;
     virtual const std::size_t getSize() = 0;
-    virtual void dumpNext(std::wostream& os) = 0;
+    virtual void dumpNext(RenderBuffer& buffer) = 0;
     virtual void reset() = 0;
 };
 
@@ -44,28 +57,33 @@ public:
 
     virtual ~Column() override = default;
 
-    std::wstring nSpace(int n)
-    {
-        return std::wstring(n, ' ');
-    }
-
-    void dumpNext(std::wostream& os) override
+    void dumpNext(RenderBuffer& buffer) override
     {
         if (currentIt == items.cend())
             return;
 
         if (!titlePrinted && !title.empty())
         {
-            os << nSpace(leftPadding)
-               << title
-               << nSpace(maxCharLength - title.size() +  rightPadding);
+            buffer.appendSpaces(leftPadding);
+            buffer.append(title);
+            buffer.appendSpaces(maxCharLength - static_cast<long>(title.size()) + rightPadding);
             titlePrinted = true;
             return;
         }
 
-        os << nSpace(leftPadding)
-           << *currentIt
-           << nSpace(maxCharLength - charLength(*currentIt) + rightPadding);
+        buffer.appendSpaces(leftPadding);
+        if constexpr (std::is_arithmetic<T>::value)
+        {
+            // the length of the formatted number is its width, no need to call charLength
+            auto number = formatColumnNumber(*currentIt);
+            buffer.append(number);
+            buffer.appendSpaces(maxCharLength - static_cast<long>(number.size()) + rightPadding);
+        }
+        else
+        {
+            buffer.append(*currentIt);
+            buffer.appendSpaces(maxCharLength - static_cast<long>(charLength(*currentIt)) + rightPadding);
+        }
 
         currentIt++;
     }
@@ -90,7 +108,7 @@ public:
     {
         items.push_back(item);
         currentIt = items.cbegin();
-        maxCharLength = std::max(maxCharLength, getMaxCharLength());
+        maxCharLength = std::max(maxCharLength, static_cast<int>(charLength(item)));
     }
 
 private:
@@ -125,48 +143,19 @@ using StringColumn = Column<std::wstring, &strLength>;
 
 inline std::size_t intLength(const int& s)
 {
-    if (s < 0) return static_cast<std::size_t>(log10(-s) + 1 + 1);
-    else if (s == 0) return 1;
-    else return static_cast<std::size_t>(log10(s) + 1);
+    return FormattedNumber::integer(s).size();
 }
 using IntColumn = Column<int, &intLength>;
 
 inline std::size_t longLength(const long& s)
 {
-    if (s < 0) return static_cast<std::size_t>(log10(-s) + 1 + 1);
-    else if (s == 0) return 1;
-    else return static_cast<std::size_t>(log10(s) + 1);
+    return FormattedNumber::integer(s).size();
 }
 using LongColumn = Column<long, &longLength>;
 
-// Specialize for double
 inline std::size_t doubleLength(const double& value)
 {
-    return intLength(value) + config::FLOAT_NUMBER_DIGITS;
-}
-
-template<>
-inline void Column<double, &doubleLength>::dumpNext(std::wostream& os)
-{
-    if (currentIt == items.cend())
-        return;
-
-    if (!titlePrinted && !title.empty())
-    {
-        os << nSpace(leftPadding)
-           << title
-           << nSpace(maxCharLength - title.size() + rightPadding);
-        titlePrinted = true;
-        return;
-    }
-
-    os << nSpace(leftPadding)
-       << std::fixed
-       << std::setprecision(config::FLOAT_NUMBER_DIGITS)
-       << *currentIt
-       << nSpace(maxCharLength - doubleLength(*currentIt) + rightPadding).c_str();
-
-    currentIt++;
+    return FormattedNumber::fixed(value, config::FLOAT_NUMBER_DIGITS).size();
 }
 using DoubleColumn = Column<double, &doubleLength>;
 
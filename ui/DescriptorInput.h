@@ -0,0 +1,166 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_DESCRIPTORINPUT_H
+#define PROJ1_DESCRIPTORINPUT_H
+
+#include <iostream>
+#include <streambuf>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+
+namespace descriptor_input_detail
+{
+    constexpr std::size_t BUFFER_BYTES = 1 << 16;
+
+    inline bool isSpace(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    /// value when all of token is one number, with an optional sign
+    template <typename T>
+    bool parseToken(std::string_view token, T& value)
+    {
+        const char* first = token.data();
+        const char* last = first + token.size();
+        // from_chars takes no plus sign
+        if (token.size() > 1 && token[0] == '+' && token[1] != '-')
+            first++;
+        auto [end, error] = std::from_chars(first, last, value);
+        return error == std::errc() && end == last;
+    }
+}
+
+/** A stream buffer that reads a file descriptor with read(2), a large block at a time.
+ *  Besides serving an istream it hands out numbers parsed straight from its buffer, for
+ *  input too long to go through operator>> one value at a time.
+ */
+class DescriptorInput : public std::streambuf
+{
+public:
+    explicit DescriptorInput(int _fd) : fd {_fd}, buffer(descriptor_input_detail::BUFFER_BYTES)
+    {
+        setg(buffer.data(), buffer.data(), buffer.data());
+    }
+
+    DescriptorInput(const DescriptorInput&) = delete;
+    DescriptorInput& operator=(const DescriptorInput&) = delete;
+
+    /// The last read found the end of the input. A terminal may still have more after it.
+    bool isAtEnd() const
+    {
+        return atEnd;
+    }
+
+    /** Pass the numbers separated by white space to consume, up to an empty line or the end
+     *  of the input; the empty line is taken too. Returns the number of tokens that are not
+     *  numbers, which are skipped.
+     */
+    template <typename T, typename Consume>
+    std::size_t readValues(Consume consume)
+    {
+        using namespace descriptor_input_detail;
+        std::size_t skipped = 0;
+        // nothing but white space since the start or the last new line
+        bool lineEmpty = true;
+        // the rest of a token longer than the buffer
+        bool dropping = false;
+        while (gptr() != egptr() || fill())
+        {
+            const char* first = gptr();
+            const char* last = egptr();
+            if (dropping)
+            {
+                first = std::find_if(first, last, isSpace);
+                dropping = first == last;
+            }
+            for (; first != last && isSpace(*first); first++)
+            {
+                if (*first != '\n')
+                    continue;
+                if (lineEmpty)
+                {
+                    setg(eback(), const_cast<char*>(first + 1), egptr());
+                    return skipped;
+                }
+                lineEmpty = true;
+            }
+            const char* tokenEnd = std::find_if(first, last, isSpace);
+            if (first != last && tokenEnd == last && !atEnd)
+            {
+                // the token may go on in the next read
+                setg(eback(), const_cast<char*>(first), egptr());
+                if (first == eback() && last == buffer.data() + buffer.size())
+                {
+                    skipped++;
+                    dropping = true;
+                    setg(eback(), egptr(), egptr());
+                }
+                else
+                    fill();
+                continue;
+            }
+            if (first != last)
+            {
+                T value;
+                if (parseToken(std::string_view(first, tokenEnd - first), value))
+                    consume(value);
+                else
+                    skipped++;
+                lineEmpty = false;
+            }
+            setg(eback(), const_cast<char*>(tokenEnd), egptr());
+        }
+        return skipped;
+    }
+
+protected:
+    int_type underflow() override
+    {
+        if (gptr() == egptr() && !fill())
+            return traits_type::eof();
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    int fd;
+    std::vector<char> buffer;
+    bool atEnd = false;
+
+    /// Move the bytes not taken yet to the front of the buffer and read more after them
+    bool fill()
+    {
+        std::size_t kept = egptr() - gptr();
+        std::memmove(buffer.data(), gptr(), kept);
+        setg(buffer.data(), buffer.data(), buffer.data() + kept);
+        ssize_t count;
+        while ((count = ::read(fd, buffer.data() + kept, buffer.size() - kept)) < 0 && errno == EINTR)
+            ;
+        // an input that cannot be read has ended
+        atEnd = count <= 0;
+        if (atEnd)
+            return false;
+        setg(buffer.data(), buffer.data(), buffer.data() + kept + count);
+        return true;
+    }
+};
+
+/** The buffer of std::cin, put in place of the standard one by the first call. Make that
+ *  call before std::cin is read, or what the standard buffer read ahead is lost.
+ */
+inline DescriptorInput& standardInput()
+{
+    static DescriptorInput input {STDIN_FILENO};
+    static std::streambuf* replaced = std::cin.rdbuf(&input);
+    (void) replaced;
+    return input;
+}
+
+#endif //PROJ1_DESCRIPTORINPUT_H
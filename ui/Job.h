@@ -0,0 +1,212 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_JOB_H
+#define PROJ1_JOB_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <csignal>
+#include <cstdio>
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include "OutputSink.h"
+#include "UIExcept.h"
+
+/// Thrown inside a job once it was asked to stop, and rethrown to the UI.
+class JobCancelled : public UIExcept
+{
+public:
+    explicit JobCancelled(const std::string& label) : UIExcept(label + " was cancelled")
+    {}
+};
+
+/** Progress of a job and the request to cancel it, shared by the job's thread and the UI.
+ *  The job calls update regularly; that is where it stops when it was cancelled.
+ */
+class JobControl
+{
+public:
+    enum class Unit
+    {
+        Bytes,
+        Elements
+    };
+
+    explicit JobControl(std::string _label) : label {std::move(_label)} {}
+
+    /// done of total units so far, total 0 when it is not known. Throws JobCancelled after a cancel.
+    void update(std::size_t _done, std::size_t _total = 0, Unit _unit = Unit::Bytes)
+    {
+        done.store(_done, std::memory_order_relaxed);
+        total.store(_total, std::memory_order_relaxed);
+        unit.store(_unit, std::memory_order_relaxed);
+        if (cancelRequested.load(std::memory_order_relaxed))
+            throw JobCancelled(label);
+    }
+
+    void requestCancel()
+    {
+        cancelRequested.store(true, std::memory_order_relaxed);
+    }
+
+    bool isCancelRequested() const
+    {
+        return cancelRequested.load(std::memory_order_relaxed);
+    }
+
+    const std::string& getLabel() const
+    {
+        return label;
+    }
+
+    /// "Loading: 45% (12.3 of 27.0 MB)"
+    std::string describe() const
+    {
+        auto format = [this](std::size_t count)
+        {
+            char text[32];
+            if (unit.load(std::memory_order_relaxed) == Unit::Bytes)
+                std::snprintf(text, sizeof(text), "%.1f", count / 1048576.0);
+            else
+                std::snprintf(text, sizeof(text), "%zu", count);
+            return std::string(text);
+        };
+        std::size_t currentDone = done.load(std::memory_order_relaxed);
+        std::size_t currentTotal = total.load(std::memory_order_relaxed);
+        std::string unitName = unit.load(std::memory_order_relaxed) == Unit::Bytes ? " MB" : " elements";
+        if (currentTotal == 0)
+            return label + ": " + format(currentDone) + unitName;
+        return label + ": " + std::to_string(currentDone * 100 / currentTotal) + "% ("
+               + format(currentDone) + " of " + format(currentTotal) + unitName + ")";
+    }
+
+private:
+    std::string label;
+    std::atomic<std::size_t> done {0};
+    std::atomic<std::size_t> total {0};
+    std::atomic<Unit> unit {Unit::Bytes};
+    std::atomic<bool> cancelRequested {false};
+};
+
+/// Counts the bytes written through it as the progress of a job, the job stops in write once cancelled.
+class ProgressSink : public OutputSink
+{
+public:
+    ProgressSink(JobControl& _job, OutputSink& _target) : job {_job}, target {_target} {}
+
+    void write(std::string_view text) override
+    {
+        // writes that come while the cancel unwinds, such as a buffer flushed by its destructor, are dropped
+        if (stopped)
+            return;
+        target.write(text);
+        written += text.size();
+        stopped = true;
+        job.update(written);
+        stopped = false;
+    }
+
+    void flush() override
+    {
+        if (!stopped)
+            target.flush();
+    }
+
+private:
+    JobControl& job;
+    OutputSink& target;
+    std::size_t written = 0;
+    bool stopped = false;
+};
+
+namespace job_detail
+{
+    inline volatile std::sig_atomic_t interrupted = 0;
+
+    inline void onInterrupt(int)
+    {
+        interrupted = 1;
+    }
+
+    constexpr int POLL_INTERVAL_MS = 200;
+}
+
+/** Run work on a worker thread while this thread waits for it. Ctrl-C cancels the job,
+ *  and so does Enter when the input is a terminal. The progress is shown on the terminal.
+ *  An exception thrown by work, JobCancelled included, is rethrown here.
+ *
+ *  work must leave the state it changes consistent when it stops with an exception.
+ */
+inline void runJob(const std::string& label, const std::function<void(JobControl&)>& work)
+{
+    using namespace job_detail;
+    auto job = JobControl(label);
+    std::exception_ptr failure;
+
+    // the worker writes a byte when it is done, which wakes the poll below at once
+    int finishedPipe[2];
+    if (::pipe(finishedPipe) != 0)
+        throw UIExcept("Cannot start " + label);
+
+    struct sigaction interruptAction {}, previousAction {};
+    interruptAction.sa_handler = onInterrupt;
+    sigemptyset(&interruptAction.sa_mask);
+    interrupted = 0;
+    ::sigaction(SIGINT, &interruptAction, &previousAction);
+
+    auto worker = std::thread([&]
+    {
+        try
+        {
+            work(job);
+        }
+        catch (...)
+        {
+            failure = std::current_exception();
+        }
+        char done = 1;
+        while (::write(finishedPipe[1], &done, 1) < 0 && errno == EINTR)
+            ;
+    });
+
+    const bool showProgress = ::isatty(STDOUT_FILENO);
+    const bool readCancel = ::isatty(STDIN_FILENO);
+    while (true)
+    {
+        pollfd inputs[2] = {{finishedPipe[0], POLLIN, 0}, {STDIN_FILENO, POLLIN, 0}};
+        int ready = ::poll(inputs, readCancel ? 2 : 1, POLL_INTERVAL_MS);
+        if (ready > 0 && (inputs[0].revents & POLLIN))
+            break;
+        if (ready > 0 && (inputs[1].revents & POLLIN))
+        {
+            std::string line;
+            std::getline(std::cin, line);
+            job.requestCancel();
+        }
+        if (interrupted)
+            job.requestCancel();
+        if (showProgress)
+            std::cout << '\r' << job.describe()
+                      << (job.isCancelRequested() ? ", cancelling..." : ", Enter or Ctrl-C to cancel")
+                      << "\x1b[K" << std::flush;
+    }
+    worker.join();
+    ::sigaction(SIGINT, &previousAction, nullptr);
+    ::close(finishedPipe[0]);
+    ::close(finishedPipe[1]);
+    if (showProgress)
+        std::cout << "\r\x1b[K" << std::flush;
+
+    if (failure)
+        std::rethrow_exception(failure);
+}
+
+#endif //PROJ1_JOB_H
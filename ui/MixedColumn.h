@@ -8,12 +8,25 @@
 #include <iostream>
 #include <string>
 #include <type_traits>
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <algorithm>
+#include <iterator>
 #include "configuration.h"
 #include "Column.h"
+#include "Table.h"
+#include "RenderBuffer.h"
+#include "NumberFormat.h"
+#include "Utf8.h"
 
 /** MixedColumn aims to provide similar functionality
  *  to the original column class with the exception that
  *  it allows the storage of many different type in a column.
+ *  Nested tables are not owned, they belong to the RenderArena they were created in.
  */
 
 //template <typename StringLikeType,
@@ -62,71 +75,102 @@ template<typename IntegerType,
         typename std::enable_if<std::is_integral<IntegerType>::value, int>::type = 0>
 std::size_t displayLength(const IntegerType& var)
 {
-    if (var < 0) return static_cast<std::size_t>(std::log10(-var) + 1 + 1);
-    else if (var == 0) return 1;
-    else return static_cast<std::size_t>(std::log10(var) + 1);
+    return FormattedNumber::streamed(var).size();
 }
 
+/// Width of a floating point number as MixedColumn::addItems shows it, in fixed notation
 template<typename FloatType,
          typename std::enable_if<std::is_floating_point<FloatType>::value, int>::type = 0>
 std::size_t displayLength(const FloatType& var)
 {
-    if (long(var) == var)
-    {
-        return displayLength(long(var));
-    }
-    return displayLength((long)var) + config::FLOAT_NUMBER_DIGITS + 1;
+    return FormattedNumber::fixed(var, config::FLOAT_NUMBER_DIGITS).size();
 }
 
-template <typename T>
-std::size_t displayLength(const std::vector<T>& vec)
+
+namespace mixed_column_detail
 {
-    std::size_t totalLength = 0;
-    if (vec.empty())
+    enum class CellKind : std::uint8_t
     {
-        return displayLength("None");
-    }
-    for (auto it = vec.cbegin(); it != --vec.cend(); it++)
+        Inline,     // the first length bytes of characters
+        Text,       // bytes [range.first, range.first + range.count) of the text pool
+        List,       // comma separated list items [range.first, range.first + range.count)
+        Table,      // tables[index]
+        None
+    };
+
+    /// Numbers up to this length are stored in the cell itself.
+    constexpr std::size_t INLINE_CAPACITY = 8;
+
+    /** One cell in 16 bytes: the kind, the display width and the UTF-8 text or a reference
+     *  into the storage of the column. Values are formatted once when they are added, so
+     *  rendering only copies bytes. There is no allocation or indirect call per cell.
+     */
+    struct Cell
     {
-        if (std::distance(vec.cbegin(), it) > config::ARRAY_MAX_WRAPPING_LENGTH)
+        CellKind kind;
+        std::uint8_t length;
+        std::uint32_t width;
+        union
         {
-            totalLength + std::string(", ...").size();
-            return totalLength;
-        }
-        totalLength += displayLength(*it) + std::string(", ").size();
-    }
-    totalLength -= std::string(", ").size();
-    return totalLength;
+            char characters[INLINE_CAPACITY];
+            struct
+            {
+                std::uint32_t first;
+                std::uint32_t count;
+            } range;
+            std::uint32_t index;
+        };
+    };
+
+    static_assert(sizeof(Cell) == 16, "Cell must stay compact");
 }
 
-
 class MixedColumn : public AbstractColumn
 {
 public:
-    MixedColumn(int _leftPadding, int _rightPadding, std::wstring&& _title)
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+    MixedColumn(std::allocator_arg_t, const allocator_type& allocator,
+                int _leftPadding, int _rightPadding, std::wstring_view _title)
         :
+        cells {allocator},
+        textPool {allocator},
+        listItems {allocator},
+        tables {allocator},
         leftPadding {_leftPadding},
         rightPadding {_rightPadding},
-        title {_title},
         maxCharLength {0},
+        title {_title, allocator},
         titlePrinted {false}
     {}
 
     template <typename ...ItemTypes>
-    MixedColumn(int _leftPadding, int _rightPadding, std::wstring&& _title, ItemTypes... items)
+    MixedColumn(std::allocator_arg_t, const allocator_type& allocator,
+                int _leftPadding, int _rightPadding, std::wstring_view _title, ItemTypes... items)
         :
-        leftPadding {_leftPadding},
-        rightPadding {_rightPadding},
-        title {_title},
-        maxCharLength {0}
+        MixedColumn(std::allocator_arg, allocator, _leftPadding, _rightPadding, _title)
+    {
+        addItems(items...);
+    }
+
+    MixedColumn(int _leftPadding, int _rightPadding, std::wstring_view _title)
+        :
+        MixedColumn(std::allocator_arg, allocator_type(), _leftPadding, _rightPadding, _title)
+    {}
+
+    template <typename ...ItemTypes>
+    MixedColumn(int _leftPadding, int _rightPadding, std::wstring_view _title, ItemTypes... items)
+        :
+        MixedColumn(std::allocator_arg, allocator_type(), _leftPadding, _rightPadding, _title)
     {
         addItems(items...);
     }
 
     template <typename T>
-    void repeatedAddItems(std::vector<T> _items)
+    void repeatedAddItems(const std::vector<T>& _items)
     {
-        for (auto item: _items)
+        cells.reserve(cells.size() + _items.size());
+        for (const auto& item: _items)
             addItems(item);
     }
 
@@ -136,62 +180,49 @@ public:
     template<>
     void addItems()
     {
-        currentIt = items.begin();
+        nextCell = 0;
         maxCharLength = std::max(maxCharLength, title.size());
     }
 
-//    template <typename ...OtherTypes>
-//    void addItems(MixedColumn* mixedColumn, OtherTypes... otherArgs)
-//    {
-//        maxCharLength = std::max(maxCharLength, static_cast<std::size_t>(mixedColumn->getColumnWidth()));
-//        items.push_back(
-//            [this, mixedColumnPtr = std::unique_ptr<MixedColumn>(mixedColumn)] (std::wostream&)
-//            {
-//                for (std::size_t i = 0; i <= mixedColumnPtr->getSize(); i++)
-//                {
-//                    mixedColumnPtr->dumpNext();
-//                }
-//            }
-//        );
-//        addItems(otherArgs...);
-//    }
-
-    template <typename ...OtherTypes>
-    void addItems(Table* table, OtherTypes... otherArgs)
+    /// Nested table of any kind: a Table, a TypedTable...
+    template <typename TableType,
+              typename std::enable_if<std::is_base_of<AbstractTable, TableType>::value, int>::type = 0,
+              typename ...OtherTypes>
+    void addItems(TableType* table, OtherTypes... otherArgs)
     {
-        maxCharLength = std::max(maxCharLength, static_cast<std::size_t>(table->tableWidth));
-        items.push_back(
-            [tablePtr = std::shared_ptr<Table>(table)] (std::wostream& os)
-            {
-                tablePtr->dumpTableTo(os);
-            }
-        );
+        tables.push_back(table);
+        auto cell = makeCell(mixed_column_detail::CellKind::Table, table->getTableWidth());
+        cell.index = static_cast<std::uint32_t>(tables.size() - 1);
+        addCell(cell);
         addItems(otherArgs...);
     }
 
     template <typename T, typename ...OtherType>
-    void addItems(std::vector<T> vec, OtherType... otherArgs)
+    void addItems(const std::vector<T>& vec, OtherType... otherArgs)
     {
-        maxCharLength = std::max(maxCharLength, displayLength(vec));
-        items.push_back(
-            [this, vec](std::wostream& os)
+        if (vec.empty())
+            addCell(makeCell(mixed_column_detail::CellKind::None, displayLength("None")));
+        else
+        {
+            listItems.reserve(listItems.size() + vec.size());
+            auto cell = makeCell(mixed_column_detail::CellKind::List, 0);
+            cell.range = {static_cast<std::uint32_t>(listItems.size()), static_cast<std::uint32_t>(vec.size())};
+            // width of the widest line, wrapped the way renderCell wraps it
+            std::size_t lineLength = 0;
+            for (std::uint32_t i = 0; i < cell.range.count; i++)
             {
-                if (vec.empty())
-                    os << "None";
-                else
+                bool isLast = i + 1 == cell.range.count;
+                if (i != 0 && !isLast && i % config::ARRAY_MAX_WRAPPING_LENGTH == 0)
                 {
-                    for (auto it = vec.cbegin(); it != --vec.cend(); it++)
-                    {
-                        if (it != vec.cbegin()
-                            && std::distance(vec.cbegin(), it) % config::ARRAY_MAX_WRAPPING_LENGTH == 0)
-                            os << std::endl;
-                        os << *it << L", ";
-                    }
-                    os << vec.back();
+                    cell.width = std::max<std::size_t>(cell.width, lineLength);
+                    lineLength = 0;
                 }
-                os << nSpace(maxCharLength - displayLength(vec) + rightPadding);
+                listItems.push_back(toStreamedCell(vec[i]));
+                lineLength += listItems.back().width + (isLast ? 0 : std::string(", ").size());
             }
-        );
+            cell.width = std::max<std::size_t>(cell.width, lineLength);
+            addCell(cell);
+        }
         addItems(otherArgs...);
     }
 
@@ -199,101 +230,29 @@ public:
     void addItems(std::optional<T> op, OtherTypes... otherArgs)
     {
         if (op.has_value())
-            maxCharLength = std::max(maxCharLength, displayLength(op.value()));
+            addCell(toStreamedCell(op.value()));
         else
-            maxCharLength = std::max(maxCharLength, displayLength("None"));
-        items.push_back(
-            [this, op](std::wostream& os)
-            {
-                if (op.has_value())
-                    os << op.value() << nSpace(maxCharLength - displayLength(op.value()) + rightPadding);
-                else
-                    os << L"None" << nSpace(maxCharLength - displayLength("None") + rightPadding);
-            }
-        );
+            addCell(makeCell(mixed_column_detail::CellKind::None, displayLength("None")));
         addItems(otherArgs...);
     }
 
-//    template <typename StringLikeType,
-//            typename std::enable_if<std::is_convertible<StringLikeType, const char*>::value, int>::type = 0,
-//            typename ...OtherType
-//            >
-//    void addItems(StringLikeType str, OtherType... otherArgs)
-//    {
-//        maxCharLength = std::max(maxCharLength, displayLength(str));
-//        items.push_back(
-//            [this, str](std::wostream& os)
-//            {
-//                os << str << nSpace(maxCharLength - displayLength(str) + rightPadding);
-//            }
-//        );
-//        addItems(otherArgs...);
-//    }
     template <typename ...OtherTypes>
     void addItems(const char* str, OtherTypes... otherArgs)
     {
-        maxCharLength = std::max(maxCharLength, displayLength(str));
-        items.push_back(
-            [this, str](std::wostream& os)
-            {
-                os << str << nSpace(maxCharLength - displayLength(str) + rightPadding);
-            }
-        );
+        addCell(toStreamedCell(str));
         addItems(otherArgs...);
     }
 
-//    template <typename StringLikeType,
-//    typename std::enable_if<std::is_convertible<StringLikeType, const wchar_t*>::value, int>::type = 0,
-//    typename ...OtherType
-//    >
-//    void addItems(StringLikeType str, OtherType... otherArgs)
-//    {
-//        maxCharLength = std::max(maxCharLength, displayLength(str));
-//        items.push_back(
-//        [this, str](std::wostream& os)
-//        {
-//            os << str << nSpace(maxCharLength - displayLength(str) + rightPadding);
-//        }
-//        );
-//        addItems(otherArgs...);
-//    }
     template <typename ...OtherTypes>
     void addItems(const wchar_t* str, OtherTypes... otherArgs)
     {
-        maxCharLength = std::max(maxCharLength, displayLength(str));
-        items.push_back(
-        [this, str](std::wostream& os)
-        {
-            os << str << nSpace(maxCharLength - displayLength(str) + rightPadding);
-        }
-        );
+        addCell(toStreamedCell(str));
         addItems(otherArgs...);
     }
 
-//    template <typename StringLikeType,
-//    typename std::enable_if<std::is_same<StringLikeType, std::wstring>::value, int>::type = 0,
-//    typename ...OtherType
-//    >
-//    void addItems(StringLikeType str, OtherType... otherArgs)
-//    {
-//        maxCharLength = std::max(maxCharLength, displayLength(str));
-//        items.push_back(
-//        [this, str](std::wostream& os)
-//        {
-//            os << str << nSpace(maxCharLength - displayLength(str) + rightPadding);
-//        }
-//        );
-//        addItems(otherArgs...);
-//    }
-
     template <typename ...OtherTypes>
     void addItems(std::wstring str, OtherTypes... otherArgs) {
-        maxCharLength = std::max(maxCharLength, displayLength(str));
-        items.push_back(
-        [this, str](std::wostream &os) {
-            os << str << nSpace(maxCharLength - displayLength(str) + rightPadding);
-        }
-        );
+        addCell(toStreamedCell(str));
         addItems(otherArgs...);
     }
 
@@ -302,13 +261,7 @@ public:
               typename ...OtherType>
     void addItems(IntegerType integer, OtherType... otherArgs)
     {
-        maxCharLength = std::max(maxCharLength, displayLength(integer));
-        items.push_back(
-            [this, integer](std::wostream& os)
-            {
-                os << integer << nSpace(maxCharLength - displayLength(integer) + rightPadding);
-            }
-        );
+        addCell(toStreamedCell(integer));
         addItems(otherArgs...);
     }
 
@@ -317,44 +270,35 @@ public:
               typename ...OtherTypes>
     void addItems(FloatingType floatVar, OtherTypes... otherArgs)
     {
-        maxCharLength = std::max(maxCharLength, displayLength(floatVar));
-        items.push_back(
-            [this, floatVar](std::wostream& os)
-            {
-                os << std::fixed << std::setprecision(config::FLOAT_NUMBER_DIGITS)
-                    << floatVar
-                    << nSpace(maxCharLength - displayLength(floatVar) + rightPadding);
-            }
-        );
+        addCell(textCell(FormattedNumber::fixed(floatVar, config::FLOAT_NUMBER_DIGITS).view()));
         addItems(otherArgs...);
     }
 
-    std::wstring nSpace(int n)
+    void dumpNext(RenderBuffer& buffer) override
     {
-        /// Call to nSpace instead of std::setw is absolutely **_necessary_**
+        /// Explicit space runs instead of std::setw are absolutely **_necessary_**
         /// because the Column class requires explicit and granular space management
         /// in order to function properly.
-        return std::wstring(n, L' ');
-    }
-
-    void dumpNext(std::wostream& os)
-    {
-        if (currentIt == items.cend())
+        if (nextCell == cells.size())
             return;
 
         if (!titlePrinted && !title.empty())
         {
-            os << nSpace(leftPadding)
-               << title
-               << nSpace(maxCharLength - title.size() + rightPadding);
+            buffer.appendSpaces(leftPadding);
+            buffer.append(title);
+            buffer.appendSpaces(maxCharLength - title.size() + rightPadding);
             titlePrinted = true;
             return;
         }
 
-        os << nSpace(leftPadding);
-        std::invoke(*currentIt, os);
+        buffer.appendSpaces(leftPadding);
+        const auto& cell = cells[nextCell];
+        renderCell(cell, buffer);
+        // nested tables end with a line break and are not padded
+        if (cell.kind != mixed_column_detail::CellKind::Table)
+            buffer.appendSpaces(maxCharLength - cell.width + rightPadding);
 
-        currentIt++;
+        nextCell++;
     }
 
     const int getColumnWidth() const override
@@ -364,23 +308,130 @@ public:
 
     const std::size_t getSize() override
     {
-        return items.size();
+        return cells.size();
     }
 
     void reset() override
     {
-        currentIt = items.cbegin();
+        nextCell = 0;
         titlePrinted = false;
     }
 
 private:
-    std::vector<std::function<void(std::wostream&)>> items;
+    std::pmr::vector<mixed_column_detail::Cell> cells;
+    // storage referenced by the cells
+    // UTF-8 text of the cells that are not inline
+    std::pmr::string textPool;
+    std::pmr::vector<mixed_column_detail::Cell> listItems;
+    std::pmr::vector<const AbstractTable*> tables;
+
     int leftPadding, rightPadding;
     std::size_t maxCharLength;
-    std::wstring title;
+    std::pmr::wstring title;
     bool titlePrinted;
 
-    decltype(items.cbegin()) currentIt;
+    std::size_t nextCell = 0;
+
+    static mixed_column_detail::Cell makeCell(mixed_column_detail::CellKind kind, std::size_t width)
+    {
+        auto cell = mixed_column_detail::Cell();
+        cell.kind = kind;
+        cell.width = static_cast<std::uint32_t>(width);
+        return cell;
+    }
+
+    void addCell(const mixed_column_detail::Cell& cell)
+    {
+        maxCharLength = std::max<std::size_t>(maxCharLength, cell.width);
+        cells.push_back(cell);
+    }
+
+    /// Cell showing UTF-8 text, inline when it is short enough
+    mixed_column_detail::Cell textCell(std::string_view text, std::size_t width)
+    {
+        using mixed_column_detail::CellKind;
+        if (text.size() <= mixed_column_detail::INLINE_CAPACITY)
+        {
+            auto cell = makeCell(CellKind::Inline, width);
+            cell.length = static_cast<std::uint8_t>(text.size());
+            std::copy(text.cbegin(), text.cend(), cell.characters);
+            return cell;
+        }
+        auto cell = makeCell(CellKind::Text, width);
+        cell.range = {static_cast<std::uint32_t>(textPool.size()), static_cast<std::uint32_t>(text.size())};
+        textPool.append(text);
+        return cell;
+    }
+
+    mixed_column_detail::Cell textCell(std::string_view text)
+    {
+        return textCell(text, text.size());
+    }
+
+    /// Wide text is stored as UTF-8, its width is one column per wchar_t.
+    mixed_column_detail::Cell textCell(std::wstring_view text)
+    {
+        // encoded straight into the pool, then moved inline when it is short enough
+        std::size_t first = textPool.size();
+        for (wchar_t c : text)
+            encodeUtf8(static_cast<char32_t>(c), std::back_inserter(textPool));
+        std::size_t length = textPool.size() - first;
+        if (length <= mixed_column_detail::INLINE_CAPACITY)
+        {
+            auto cell = textCell(std::string_view(textPool.data() + first, length), text.size());
+            textPool.resize(first);
+            return cell;
+        }
+        auto cell = makeCell(mixed_column_detail::CellKind::Text, text.size());
+        cell.range = {static_cast<std::uint32_t>(first), static_cast<std::uint32_t>(length)};
+        return cell;
+    }
+
+    /// Cell showing value the way `os << value` does on a stream with default flags
+    template <typename T>
+    mixed_column_detail::Cell toStreamedCell(const T& value)
+    {
+        if constexpr (std::is_same<T, char>::value)
+            return textCell(std::string_view(&value, 1));
+        else if constexpr (std::is_same<T, wchar_t>::value)
+            return textCell(std::wstring_view(&value, 1));
+        else if constexpr (std::is_arithmetic<T>::value)
+            return textCell(FormattedNumber::streamed(value).view());
+        else if constexpr (std::is_convertible<T, const char*>::value)
+            return textCell(std::string_view(value));
+        else
+            return textCell(std::wstring_view(value));
+    }
+
+    void renderCell(const mixed_column_detail::Cell& cell, RenderBuffer& buffer) const
+    {
+        using mixed_column_detail::CellKind;
+        switch (cell.kind)
+        {
+            case CellKind::Inline:
+                buffer.append(std::string_view(cell.characters, cell.length));
+                break;
+            case CellKind::Text:
+                buffer.append(std::string_view(textPool.data() + cell.range.first, cell.range.count));
+                break;
+            case CellKind::List:
+                for (std::uint32_t i = 0; i < cell.range.count; i++)
+                {
+                    if (i != 0 && i + 1 != cell.range.count && i % config::ARRAY_MAX_WRAPPING_LENGTH == 0)
+                        buffer.newline();
+                    renderCell(listItems[cell.range.first + i], buffer);
+                    if (i + 1 != cell.range.count)
+                        buffer.append(", ");
+                }
+                break;
+            case CellKind::Table:
+                tables[cell.index]->renderTo(buffer);
+                break;
+            case CellKind::None:
+                buffer.append("None");
+                break;
+        }
+    }
 };
 
 
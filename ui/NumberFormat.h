@@ -0,0 +1,126 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_NUMBERFORMAT_H
+#define PROJ1_NUMBERFORMAT_H
+
+#include <charconv>
+#include <cmath>
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+/** Text of one number, formatted once with std::to_chars into an inline buffer.
+ *  std::to_chars does not allocate and does not consult the locale, and the
+ *  length it produces is the display width of the number, so widths never
+ *  need to be computed separately.
+ */
+class FormattedNumber
+{
+public:
+    // Room for the fixed notation of the largest double
+    static constexpr std::size_t CAPACITY = 384;
+
+    static FormattedNumber integer(long long value)
+    {
+        return format(value);
+    }
+
+    static FormattedNumber unsignedInteger(unsigned long long value)
+    {
+        return format(value);
+    }
+
+    /// Same text as std::fixed << std::setprecision(precision)
+    static FormattedNumber fixed(double value, int precision)
+    {
+        // Fast path: scale to an integer and print that. The scaled product is within
+        // 1e-7 of the exact value below 1e9, so unless it sits right next to a rounding
+        // boundary, rounding it gives the same digits as exact decimal conversion.
+        if (precision >= 0 && precision < MAX_FAST_PRECISION && std::isfinite(value))
+        {
+            double scaled = std::fabs(value) * POWERS_OF_TEN[precision];
+            if (scaled < 1e9 && std::fabs(scaled - std::floor(scaled) - 0.5) > 1e-6)
+                return fromScaled(std::signbit(value), static_cast<unsigned long long>(scaled + 0.5), precision);
+        }
+        return format(value, std::chars_format::fixed, precision);
+    }
+
+    /// Same text as the default floating point format of a stream
+    static FormattedNumber general(double value)
+    {
+        return format(value, std::chars_format::general, 6);
+    }
+
+    /// Shortest text that reads back as exactly the same double
+    static FormattedNumber shortest(double value)
+    {
+        return format(value);
+    }
+
+    /// Same text as `os << value` on a stream with default flags
+    template <typename T>
+    static FormattedNumber streamed(const T& value)
+    {
+        static_assert(std::is_arithmetic<T>::value, "Only numbers can be formatted");
+        if constexpr (std::is_floating_point<T>::value)
+            return general(value);
+        else if constexpr (std::is_signed<T>::value)
+            return integer(value);
+        else
+            return unsignedInteger(value);
+    }
+
+    const char* data() const { return digits; }
+
+    std::size_t size() const { return length; }
+
+    std::string_view view() const { return std::string_view(digits, length); }
+
+private:
+    char digits[CAPACITY];
+    std::size_t length;
+
+    static constexpr int MAX_FAST_PRECISION = 7;
+    static constexpr double POWERS_OF_TEN[MAX_FAST_PRECISION] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6};
+
+    FormattedNumber() = default;
+
+    /// Text of scaled / 10^precision with exactly precision decimals
+    static FormattedNumber fromScaled(bool negative, unsigned long long scaled, int precision)
+    {
+        // digits of scaled, zero padded so there is at least one digit before the point
+        char scaledDigits[32];
+        char* digitsEnd = std::to_chars(scaledDigits + MAX_FAST_PRECISION, scaledDigits + sizeof(scaledDigits), scaled).ptr;
+        std::size_t digitCount = digitsEnd - (scaledDigits + MAX_FAST_PRECISION);
+        std::size_t padding = digitCount <= static_cast<std::size_t>(precision) ? precision + 1 - digitCount : 0;
+        char* digitsBegin = std::fill_n(scaledDigits + MAX_FAST_PRECISION - padding, padding, '0') - padding;
+        char* point = digitsEnd - precision;
+
+        FormattedNumber number;
+        char* out = number.digits;
+        if (negative)
+            *out++ = '-';
+        out = std::copy(digitsBegin, point, out);
+        if (precision > 0)
+        {
+            *out++ = '.';
+            out = std::copy(point, digitsEnd, out);
+        }
+        number.length = out - number.digits;
+        return number;
+    }
+
+    template <typename ...Args>
+    static FormattedNumber format(Args... args)
+    {
+        FormattedNumber number;
+        auto [end, error] = std::to_chars(number.digits, number.digits + CAPACITY, args...);
+        number.length = error == std::errc() ? end - number.digits : 0;
+        return number;
+    }
+};
+
+#endif //PROJ1_NUMBERFORMAT_H
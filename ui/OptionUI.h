@@ -6,6 +6,7 @@
 #define PROJ1_OPTIONUI_H
 
 #include <optional>
+#include <tuple>
 #include "Prerequisite.h"
 #include "Parameter.h"
 #include "UIExcept.h"
@@ -13,7 +14,9 @@
 class SingularOption
 {
 public:
-    std::function<void(std::ostream&)> invokeOption;
+    /// Prompts for the parameters, or takes them from the script when it is not null.
+    /// Errors are shown on the stream when prompting, and thrown when running a script.
+    std::function<void(std::ostream&, ScriptInput*)> invokeOption;
 
     SingularOption() = default;
 
@@ -26,22 +29,30 @@ public:
     template <typename OptionHandler_t, typename ...AbstractParameters>
     void bindHandler(OptionHandler_t optionHandler, AbstractParameters... requiredParams)
     {
-        invokeOption = [this, optionHandler, requiredParams...] ( std::ostream& os )
+        invokeOption = [this, optionHandler, requiredParams...] ( std::ostream& os, ScriptInput* script )
         {
             for (auto& prerequisite: prerequisites)
             {
                 if (!prerequisite->isSatisfied())
                 {
+                    if (script != nullptr)
+                        throw UIExcept(prerequisite->getErrorMsg());
                     os << prerequisite->getErrorMsg() << std::endl;
                     return;
                 }
             }
             try
             {
-                optionHandler(requiredParams.collectParam()...);
+                // Braced initialization guarantees the parameters are prompted in order.
+                auto collectedParams = std::tuple<decltype(requiredParams.collectParam())...> {
+                    requiredParams.collectParam(script)...
+                };
+                std::apply(optionHandler, std::move(collectedParams));
             }
             catch (UIExcept& e)
             {
+                if (script != nullptr)
+                    throw;
                 os << e.what() << std::endl;
                 return;
             }
@@ -87,7 +98,7 @@ public:
     void processOption(char optionCharacter)
     {
         auto option = options.find(optionCharacter);
-        option->second->invokeOption(std::cout);
+        option->second->invokeOption(std::cout, script);
     }
 
     virtual void init() = 0;
@@ -104,7 +115,7 @@ public:
         {
             if (options.find(userChoice) == options.end())
             {
-                std::wcout << "Option was not registered" << std::endl;
+                std::cout << "Option was not registered" << std::endl;
             }
             else
             {
@@ -114,10 +125,56 @@ public:
         }
     }
 
+    /** Run the options of a script without prompts or menus, until the script ends or
+     *  reaches the terminate character. Returns the exit status: 0 when every option
+     *  succeeded, 1 when an option failed and 2 when the script itself is invalid.
+     *  The error is written to std::cerr.
+     */
+    int runScript(ScriptInput& input)
+    {
+        this->init();
+        script = &input;
+        try
+        {
+            while (!input.isExhausted())
+            {
+                char choice = choiceCollector.collectParam(input);
+                if (choice == terminateCharacter)
+                    break;
+                if (options.find(choice) == options.end())
+                    throw ScriptError(std::string("Option ") + choice + " was not registered");
+                processOption(choice);
+            }
+        }
+        catch (ScriptError& e)
+        {
+            script = nullptr;
+            std::cerr << "ERROR: " << e.what() << std::endl;
+            return 2;
+        }
+        catch (UIExcept& e)
+        {
+            script = nullptr;
+            std::cerr << "ERROR: " << e.what() << std::endl;
+            return 1;
+        }
+        script = nullptr;
+        return 0;
+    }
+
 protected:
     CharParameter choiceCollector;
     std::optional<char> terminateCharacter;
     std::map<char, std::unique_ptr<SingularOption>> options;
+    // set while a script runs, parameters are then taken from it
+    ScriptInput* script = nullptr;
+
+    /// Parameter collected inside an option handler, from the script when one runs
+    template <typename T>
+    T collect(const AbstractParameter<T>& parameter) const
+    {
+        return parameter.collectParam(script);
+    }
 };
 
 #endif //PROJ1_OPTIONUI_H
@@ -0,0 +1,150 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_OUTPUTSINK_H
+#define PROJ1_OUTPUTSINK_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cerrno>
+#include <unistd.h>
+#include "Utf8.h"
+#include "UIExcept.h"
+
+/// Destination of rendered UTF-8 text, written in large blocks by a RenderBuffer.
+class OutputSink
+{
+public:
+    OutputSink() = default;
+    virtual ~OutputSink() = default;
+
+    virtual void write(std::string_view text) = 0;
+    virtual void flush() {}
+};
+
+/// Writes straight to a file descriptor with write(2), without any stream buffering.
+class FileDescriptorSink : public OutputSink
+{
+public:
+    /// With closeOnDestroy the sink takes ownership of fd.
+    explicit FileDescriptorSink(int _fd, bool _closeOnDestroy = false)
+        :
+        fd {_fd},
+        closeOnDestroy {_closeOnDestroy}
+    {}
+
+    FileDescriptorSink(const FileDescriptorSink&) = delete;
+    FileDescriptorSink& operator=(const FileDescriptorSink&) = delete;
+
+    ~FileDescriptorSink() override
+    {
+        if (closeOnDestroy)
+            ::close(fd);
+    }
+
+    void write(std::string_view text) override
+    {
+        while (!text.empty())
+        {
+            ssize_t written = ::write(fd, text.data(), text.size());
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written <= 0)
+                throw UIExcept("Cannot write output");
+            text.remove_prefix(written);
+        }
+    }
+
+private:
+    int fd;
+    bool closeOnDestroy;
+};
+
+/** Keeps everything written to it in memory, in the blocks it was written in, so text
+ *  rendered once can be written to several sinks.
+ */
+class MemorySink : public OutputSink
+{
+public:
+    MemorySink() = default;
+
+    void write(std::string_view text) override
+    {
+        chunks.emplace_back(text);
+        size += text.size();
+    }
+
+    /// Write everything kept so far to sink
+    void writeTo(OutputSink& sink) const
+    {
+        for (const auto& chunk : chunks)
+            sink.write(chunk);
+        sink.flush();
+    }
+
+    std::size_t getSize() const
+    {
+        return size;
+    }
+
+private:
+    std::vector<std::string> chunks;
+    std::size_t size = 0;
+};
+
+class StreamSink : public OutputSink
+{
+public:
+    explicit StreamSink(std::ostream& _os) : os {_os} {}
+
+    void write(std::string_view text) override
+    {
+        os.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    void flush() override
+    {
+        os.flush();
+    }
+
+private:
+    std::ostream& os;
+};
+
+/// Adapter for wide streams: decodes the UTF-8 text back to wchar_t.
+class WideStreamSink : public OutputSink
+{
+public:
+    explicit WideStreamSink(std::wostream& _os) : os {_os} {}
+
+    void write(std::string_view text) override
+    {
+        std::size_t size = 0;
+        decoder.decode(text, [this, &size](char32_t codePoint)
+        {
+            wideText[size++] = static_cast<wchar_t>(codePoint);
+            if (size == CHUNK_SIZE)
+            {
+                os.write(wideText, static_cast<std::streamsize>(size));
+                size = 0;
+            }
+        });
+        os.write(wideText, static_cast<std::streamsize>(size));
+    }
+
+    void flush() override
+    {
+        os.flush();
+    }
+
+private:
+    static constexpr std::size_t CHUNK_SIZE = 4096;
+    std::wostream& os;
+    Utf8Decoder decoder;
+    wchar_t wideText[CHUNK_SIZE];
+};
+
+#endif //PROJ1_OUTPUTSINK_H
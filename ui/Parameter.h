@@ -6,8 +6,15 @@
 #define PROJ1_PARAMETER_H
 
 #include <string>
+#include <sstream>
 #include <optional>
+#include <functional>
+#include <vector>
+#include <algorithm>
 #include "inputType.h"
+#include "ScriptInput.h"
+#include "DescriptorInput.h"
+#include "UIExcept.h"
 
 template <typename T>
 class AbstractParameter
@@ -36,14 +43,132 @@ public:
                 return input;
         } while (true);
     }
+    /// The next token of script instead of a prompt. A value that is not valid ends the script.
+    T collectParam(ScriptInput& script) const
+    {
+        auto token = script.next(describe());
+        T input;
+        if constexpr (std::is_same<T, std::string>::value)
+            input = token;
+        else
+        {
+            // same reading as the prompt, but the whole token must be used
+            std::istringstream is(token);
+            if (!(is >> input) || is.peek() != std::istringstream::traits_type::eof())
+                throw ScriptError("Invalid value '" + token + "' for \"" + describe() + "\"");
+        }
+        if (validator.has_value() && !validator.value()(input))
+            throw ScriptError("Invalid value '" + token + "' for \"" + describe() + "\"");
+        return input;
+    }
+
+    /// From script when there is one, otherwise from a prompt
+    T collectParam(ScriptInput* script) const
+    {
+        return script != nullptr ? collectParam(*script) : collectParam();
+    }
+
 private:
     std::string prompt;
+
+    /// The prompt without its trailing ": "
+    std::string describe() const
+    {
+        return prompt.substr(0, prompt.find_last_not_of(": ") + 1);
+    }
     std::optional<std::function<bool(const T&)>> validator;
 };
 
+/** Any number of values at one prompt, typed or piped in: numbers separated by white space,
+ *  over as many lines as needed, up to an empty line or the end of the input. They are parsed
+ *  straight from the buffer of standardInput(), however many there are.
+ */
+template <typename T>
+class VectorParameter
+{
+public:
+    explicit VectorParameter(std::string&& _prompt) :
+        prompt {_prompt},
+        validator {std::nullopt}
+    {}
+    VectorParameter(std::string&& _prompt,
+                    std::function<bool(const std::vector<T>&)> _validator) :
+        prompt {_prompt},
+        validator {_validator}
+    {}
+
+    std::vector<T> collectParam() const
+    {
+        auto& input = standardInput();
+        do
+        {
+            std::cout << prompt << std::flush;
+            std::vector<T> values;
+            std::size_t skipped = input.template readValues<T>([&values](const T& value) { values.push_back(value); });
+            if (skipped > 0)
+                std::cout << "WARNING: Skipped " << skipped << " entries that are not numbers." << std::endl;
+            if (!validator.has_value() || validator.value()(values))
+                return values;
+            std::cout << "ERROR: Input did not pass validator\'s check." << std::endl;
+            // at the end of a pipe nothing more can be entered
+            if (input.isAtEnd())
+                throw UIExcept("No more input");
+        } while (true);
+    }
+    /** The next token of script: the values separated by commas, or - to read them from
+     *  standard input like the prompt does. A value that is not valid ends the script.
+     */
+    std::vector<T> collectParam(ScriptInput& script) const
+    {
+        auto token = script.next(describe());
+        std::vector<T> values;
+        auto collect = [&values](const T& value) { values.push_back(value); };
+        if (token == "-")
+        {
+            std::size_t skipped = standardInput().template readValues<T>(collect);
+            if (skipped > 0)
+                throw ScriptError(std::to_string(skipped) + " entries for \"" + describe() + "\" are not numbers");
+        }
+        else
+        {
+            for (std::size_t start = 0; start <= token.size();)
+            {
+                std::size_t end = std::min(token.find(',', start), token.size());
+                T value;
+                auto entry = std::string_view(token).substr(start, end - start);
+                if (!descriptor_input_detail::parseToken(entry, value))
+                    throw ScriptError("Invalid value '" + std::string(entry) + "' for \"" + describe() + "\"");
+                collect(value);
+                start = end + 1;
+            }
+        }
+        if (validator.has_value() && !validator.value()(values))
+            throw ScriptError("Invalid value '" + token + "' for \"" + describe() + "\"");
+        return values;
+    }
+
+    /// From script when there is one, otherwise from a prompt
+    std::vector<T> collectParam(ScriptInput* script) const
+    {
+        return script != nullptr ? collectParam(*script) : collectParam();
+    }
+
+private:
+    std::string prompt;
+
+    /// The prompt without its trailing ": "
+    std::string describe() const
+    {
+        return prompt.substr(0, prompt.find_last_not_of(": ") + 1);
+    }
+    std::optional<std::function<bool(const std::vector<T>&)>> validator;
+};
+
 using LongParameter = AbstractParameter<long>;
 using DoubleParameter = AbstractParameter<double>;
 using CharParameter = AbstractParameter<char>;
 using StringParameter = AbstractParameter<std::string>;
+using LongVectorParameter = VectorParameter<long>;
+using DoubleVectorParameter = VectorParameter<double>;
 
 #endif //PROJ1_PARAMETER_H
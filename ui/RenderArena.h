@@ -0,0 +1,77 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_RENDERARENA_H
+#define PROJ1_RENDERARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+/** Owner of every object of one render: tables, columns and the cells they store.
+ *  Memory comes from a few large blocks and is released all at once when the arena
+ *  is destroyed, after the objects created in it are destroyed, newest first.
+ *
+ *  Types with an allocator_type are built with the arena allocator (std::allocator_arg
+ *  first), so their containers draw from the same blocks.
+ */
+class RenderArena
+{
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE = 1 << 16;
+
+    explicit RenderArena(std::size_t initialBlockSize = DEFAULT_BLOCK_SIZE)
+        :
+        memory {initialBlockSize},
+        destructors {nullptr}
+    {}
+
+    RenderArena(const RenderArena&) = delete;
+    RenderArena& operator=(const RenderArena&) = delete;
+
+    ~RenderArena()
+    {
+        for (auto* destructor = destructors; destructor != nullptr; destructor = destructor->next)
+            destructor->destroy(destructor->object);
+    }
+
+    allocator_type getAllocator()
+    {
+        return allocator_type(&memory);
+    }
+
+    template <typename T, typename ...Args>
+    T* create(Args&&... args)
+    {
+        auto allocator = std::pmr::polymorphic_allocator<T>(&memory);
+        T* object = allocator.allocate(1);
+        // uses-allocator construction hands the arena to allocator aware types
+        allocator.construct(object, std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible<T>::value)
+        {
+            auto* destructor = std::pmr::polymorphic_allocator<Destructor>(&memory).allocate(1);
+            destructor->destroy = [](void* destroyed) { static_cast<T*>(destroyed)->~T(); };
+            destructor->object = object;
+            destructor->next = destructors;
+            destructors = destructor;
+        }
+        return object;
+    }
+
+private:
+    struct Destructor
+    {
+        void (*destroy)(void*);
+        void* object;
+        Destructor* next;
+    };
+
+    std::pmr::monotonic_buffer_resource memory;
+    Destructor* destructors;
+};
+
+#endif //PROJ1_RENDERARENA_H
@@ -0,0 +1,161 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_RENDERBUFFER_H
+#define PROJ1_RENDERBUFFER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory_resource>
+#include <algorithm>
+#include "NumberFormat.h"
+#include "OutputSink.h"
+#include "Utf8.h"
+
+/** UTF-8 output buffer shared by a Table and all of its columns while rendering.
+ *  Characters are collected into one preallocated buffer and written to the
+ *  sink in large blocks. newline() continues on the next line at the current
+ *  indentation, which is how multi-line cells and nested tables stay aligned
+ *  under the column they belong to.
+ */
+class RenderBuffer
+{
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 1 << 16;
+
+    explicit RenderBuffer(OutputSink& _sink, std::size_t capacity = DEFAULT_CAPACITY,
+                          const std::pmr::polymorphic_allocator<char>& allocator = {})
+        :
+        sink {_sink},
+        buffer (std::max<std::size_t>(capacity, MAX_CHUNK), allocator),
+        size {0},
+        indent {0}
+    {}
+
+    RenderBuffer(const RenderBuffer&) = delete;
+    RenderBuffer& operator=(const RenderBuffer&) = delete;
+
+    /// Writers call flush() themselves to see write errors. This one may run while an exception
+    /// unwinds the stack, so an error writing what is left is dropped.
+    ~RenderBuffer()
+    {
+        try
+        {
+            flush();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void append(char c)
+    {
+        reserve(1);
+        buffer[size++] = c;
+    }
+
+    /// Append UTF-8 text.
+    void append(std::string_view text)
+    {
+        while (!text.empty())
+        {
+            std::size_t chunk = std::min(text.size(), MAX_CHUNK);
+            reserve(chunk);
+            std::copy(text.data(), text.data() + chunk, buffer.data() + size);
+            size += chunk;
+            text.remove_prefix(chunk);
+        }
+    }
+
+    void append(const char* str)
+    {
+        append(std::string_view(str));
+    }
+
+    void append(const std::string& str)
+    {
+        append(std::string_view(str));
+    }
+
+    /// Wide text is encoded to UTF-8.
+    void append(std::wstring_view text)
+    {
+        for (wchar_t c : text)
+        {
+            reserve(MAX_UTF8_LENGTH);
+            size = encodeUtf8(static_cast<char32_t>(c), buffer.data() + size) - buffer.data();
+        }
+    }
+
+    void append(const wchar_t* str)
+    {
+        append(std::wstring_view(str));
+    }
+
+    void append(const std::wstring& str)
+    {
+        append(std::wstring_view(str));
+    }
+
+    void append(const FormattedNumber& number)
+    {
+        append(number.view());
+    }
+
+    /// Append c n times, nothing when n is not positive.
+    void appendRepeated(char c, long n)
+    {
+        while (n > 0)
+        {
+            auto chunk = static_cast<std::size_t>(std::min<long>(n, MAX_CHUNK));
+            reserve(chunk);
+            std::fill_n(buffer.data() + size, chunk, c);
+            size += chunk;
+            n -= static_cast<long>(chunk);
+        }
+    }
+
+    void appendSpaces(long n)
+    {
+        appendRepeated(' ', n);
+    }
+
+    /// End the current line and indent the next one.
+    void newline()
+    {
+        append('\n');
+        appendSpaces(indent);
+    }
+
+    int getIndent() const { return indent; }
+
+    void setIndent(int _indent) { indent = _indent; }
+
+    /// Write everything buffered so far to the sink.
+    void flush()
+    {
+        if (size > 0)
+            sink.write(std::string_view(buffer.data(), size));
+        size = 0;
+    }
+
+private:
+    // Largest piece written into the buffer at once
+    static constexpr std::size_t MAX_CHUNK = 256;
+    static constexpr std::size_t MAX_UTF8_LENGTH = 4;
+
+    OutputSink& sink;
+    std::pmr::vector<char> buffer;
+    std::size_t size;
+    int indent;
+
+    void reserve(std::size_t n)
+    {
+        if (size + n > buffer.size())
+            flush();
+    }
+};
+
+#endif //PROJ1_RENDERBUFFER_H
@@ -0,0 +1,98 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_SCRIPTINPUT_H
+#define PROJ1_SCRIPTINPUT_H
+
+#include <iostream>
+#include <string>
+#include <deque>
+#include <cctype>
+#include <limits>
+#include "UIExcept.h"
+
+/// Script that cannot run: an unknown option or a missing or invalid parameter.
+class ScriptError : public UIExcept
+{
+public:
+    using UIExcept::UIExcept;
+};
+
+/** Options and parameters given up front instead of typed at prompts, one token each,
+ *  in the order the prompts would ask for them: "a data.txt n w c report.csv".
+ */
+class ScriptInput
+{
+public:
+    /// Tokens argv[first], ..., argv[argc - 1]
+    static ScriptInput fromArguments(int argc, char** argv, int first)
+    {
+        auto script = ScriptInput();
+        for (int i = first; i < argc; i++)
+            script.tokens.emplace_back(argv[i]);
+        return script;
+    }
+
+    /** Tokens of a script file. Tokens are separated by white space, a token in double
+     *  quotes may contain spaces, and a # starts a comment that runs to the end of the line.
+     */
+    static ScriptInput fromStream(std::istream& is)
+    {
+        auto script = ScriptInput();
+        char c;
+        while (is.get(c))
+        {
+            if (std::isspace(static_cast<unsigned char>(c)))
+                continue;
+            if (c == '#')
+            {
+                is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                continue;
+            }
+            auto token = std::string();
+            if (c == '"')
+            {
+                // c keeps the opening quote when the stream ends first
+                bool closed = false;
+                while (!closed && is.get(c))
+                {
+                    if (c == '"')
+                        closed = true;
+                    else
+                        token.push_back(c);
+                }
+                if (!closed)
+                    throw ScriptError("Unterminated quote in script");
+            }
+            else
+            {
+                token.push_back(c);
+                while (is.get(c) && !std::isspace(static_cast<unsigned char>(c)))
+                    token.push_back(c);
+            }
+            script.tokens.push_back(std::move(token));
+        }
+        return script;
+    }
+
+    bool isExhausted() const
+    {
+        return tokens.empty();
+    }
+
+    /// The next token, what names the value that is expected when there is none left
+    std::string next(const std::string& what)
+    {
+        if (tokens.empty())
+            throw ScriptError("Missing value for \"" + what + "\"");
+        auto token = std::move(tokens.front());
+        tokens.pop_front();
+        return token;
+    }
+
+private:
+    std::deque<std::string> tokens;
+};
+
+#endif //PROJ1_SCRIPTINPUT_H
@@ -0,0 +1,285 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_STREAMINGCOLUMN_H
+#define PROJ1_STREAMINGCOLUMN_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+#include "Column.h"
+#include "RenderBuffer.h"
+#include "NumberFormat.h"
+
+/// Rows of a streaming table, produced one at a time and replayable from the first one.
+template <typename Row>
+class RowStream
+{
+public:
+    RowStream() = default;
+    virtual ~RowStream() = default;
+
+    /// Start again before the first row
+    virtual void rewind() = 0;
+    /// Store the next row, false when there is none left
+    virtual bool next(Row& row) = 0;
+};
+
+/** At most limit rows of a cursor. The cursor type must be copyable and have
+ *  `bool next(Row&)`; a copy of it is kept to rewind.
+ */
+template <typename Cursor, typename Row>
+class CursorRowStream : public RowStream<Row>
+{
+public:
+    CursorRowStream(const Cursor& _first, std::size_t _limit)
+        :
+        first {_first},
+        current {_first},
+        limit {_limit},
+        produced {0}
+    {}
+
+    void rewind() override
+    {
+        current = first;
+        produced = 0;
+    }
+
+    bool next(Row& row) override
+    {
+        if (produced == limit || !current.next(row))
+            return false;
+        produced++;
+        return true;
+    }
+
+private:
+    Cursor first;
+    Cursor current;
+    std::size_t limit;
+    std::size_t produced;
+};
+
+/// Rows that were already computed, for views that cannot be produced in order.
+template <typename Row>
+class VectorRowStream : public RowStream<Row>
+{
+public:
+    explicit VectorRowStream(std::vector<Row>&& _rows)
+        :
+        rows {std::move(_rows)},
+        nextRow {0}
+    {}
+
+    void rewind() override
+    {
+        nextRow = 0;
+    }
+
+    bool next(Row& row) override
+    {
+        if (nextRow == rows.size())
+            return false;
+        row = rows[nextRow++];
+        return true;
+    }
+
+private:
+    std::vector<Row> rows;
+    std::size_t nextRow;
+};
+
+/// Rows of another stream, each one passed through transform. The source must outlive it.
+template <typename Source, typename Row, typename Transform>
+class TransformedRowStream : public RowStream<Row>
+{
+public:
+    TransformedRowStream(RowStream<Source>& _source, Transform _transform)
+        :
+        source {_source},
+        transform {std::move(_transform)},
+        current {}
+    {}
+
+    void rewind() override
+    {
+        source.rewind();
+    }
+
+    bool next(Row& row) override
+    {
+        if (!source.next(current))
+            return false;
+        row = transform(current);
+        return true;
+    }
+
+private:
+    RowStream<Source>& source;
+    Transform transform;
+    Source current;
+};
+
+/** Current row of a RowStream, shared by the columns of one table. A table asks every
+ *  column for row i before any column asks for row i + 1, so while rendering the stream
+ *  only moves forward and a single row is held in memory. The stream must outlive the
+ *  cursor, usually both are created in the same RenderArena.
+ */
+template <typename Row>
+class SharedRowCursor
+{
+public:
+    explicit SharedRowCursor(RowStream<Row>& _stream)
+        :
+        stream {_stream},
+        current {},
+        position {0},
+        rowCount {0}
+    {
+        forEach([this](const Row&) { rowCount++; });
+    }
+
+    std::size_t size() const
+    {
+        return rowCount;
+    }
+
+    /// Call visit on every row, in order
+    template <typename Visit>
+    void forEach(Visit visit)
+    {
+        rewind();
+        while (stream.next(current))
+            visit(current);
+        rewind();
+    }
+
+    /// Row at index. Going back to an earlier row replays the stream from the start.
+    const Row& at(std::size_t index)
+    {
+        if (index + 1 < position)
+            rewind();
+        while (position <= index && stream.next(current))
+            position++;
+        return current;
+    }
+
+private:
+    RowStream<Row>& stream;
+    Row current;
+    // number of rows read since the last rewind, current is row position - 1
+    std::size_t position;
+    std::size_t rowCount;
+
+    void rewind()
+    {
+        stream.rewind();
+        position = 0;
+    }
+};
+
+/** Column showing one field of the rows of a SharedRowCursor, which must outlive it.
+ *  Cells are formatted when they are rendered, so memory does not grow with the number
+ *  of rows. The width is measured up front with one extra pass over the rows.
+ */
+template <typename Row, typename T>
+class StreamingColumn : public AbstractColumn
+{
+public:
+    static_assert(std::is_arithmetic<T>::value, "Streaming columns show numbers");
+
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+    StreamingColumn(
+        std::allocator_arg_t,
+        const allocator_type& allocator,
+        SharedRowCursor<Row>& _rows,
+        std::function<T(const Row&)> _field,
+        int _leftPadding,
+        int _rightPadding,
+        std::wstring_view _title
+    )
+    :
+        rows {_rows},
+        field {std::move(_field)},
+        leftPadding {_leftPadding},
+        rightPadding {_rightPadding},
+        title {_title, allocator},
+        nextRow {0},
+        titlePrinted {false},
+        maxCharLength {static_cast<long>(title.size())}
+    {
+        rows.forEach([this](const Row& row)
+        {
+            maxCharLength = std::max(maxCharLength, static_cast<long>(formatColumnNumber(field(row)).size()));
+        });
+    }
+
+    StreamingColumn(
+        SharedRowCursor<Row>& _rows,
+        std::function<T(const Row&)> _field,
+        int _leftPadding,
+        int _rightPadding,
+        std::wstring_view _title
+    )
+    :
+        StreamingColumn(std::allocator_arg, allocator_type(), _rows, std::move(_field),
+                        _leftPadding, _rightPadding, _title)
+    {}
+
+    void dumpNext(RenderBuffer& buffer) override
+    {
+        if (nextRow == rows.size())
+            return;
+
+        if (!titlePrinted && !title.empty())
+        {
+            buffer.appendSpaces(leftPadding);
+            buffer.append(title);
+            buffer.appendSpaces(maxCharLength - static_cast<long>(title.size()) + rightPadding);
+            titlePrinted = true;
+            return;
+        }
+
+        buffer.appendSpaces(leftPadding);
+        auto number = formatColumnNumber(field(rows.at(nextRow)));
+        buffer.append(number);
+        buffer.appendSpaces(maxCharLength - static_cast<long>(number.size()) + rightPadding);
+        nextRow++;
+    }
+
+    const int getColumnWidth() const override
+    {
+        return leftPadding + static_cast<int>(maxCharLength) + rightPadding;
+    }
+
+    const std::size_t getSize() override
+    {
+        return rows.size();
+    }
+
+    void reset() override
+    {
+        nextRow = 0;
+        titlePrinted = false;
+    }
+
+private:
+    SharedRowCursor<Row>& rows;
+    std::function<T(const Row&)> field;
+    int leftPadding;
+    int rightPadding;
+    std::pmr::wstring title;
+    std::size_t nextRow;
+    bool titlePrinted;
+    long maxCharLength;
+};
+
+#endif //PROJ1_STREAMINGCOLUMN_H
@@ -10,138 +10,202 @@
 #include <algorithm>
 #include <vector>
 #include <type_traits>
-#include <sstream>
+#include <string>
+#include <string_view>
+#include <memory_resource>
+#include <initializer_list>
+#include <iterator>
 #include "Column.h"
+#include "RenderBuffer.h"
+#include "OutputSink.h"
 #include "configuration.h"
 
 void tableDemo();
 
-class Table {
+/** Anything that renders as a table, so tables of different kinds can be nested in a
+ *  MixedColumn. Only whole tables go through these virtual calls, never single cells.
+ */
+class AbstractTable
+{
 public:
-    int tableWidth;
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
 
-    Table(const std::vector<AbstractColumn*>& _columns, std::wstring _title)
+    explicit AbstractTable(const allocator_type& _allocator)
     :
-    columns {_columns},
-    title {_title},
-    tableWidth {0},
-    consoleWidth {config::CONSOLE_WIDTH}
+    allocator {_allocator}
+    {}
+
+    virtual ~AbstractTable() = default;
+
+    /// Width of the rendered lines, padding included
+    virtual int getTableWidth() const = 0;
+
+    /** Render the table into a buffer. Lines are continued at the buffer's current
+     *  indentation, so a table rendered inside a cell stays under that cell.
+     */
+    virtual void renderTo(RenderBuffer& buffer) const = 0;
+
+    void dumpTableTo(OutputSink& sink) const
     {
-        // Center table
-        tableWidth = std::transform_reduce(
-        columns.cbegin(), columns.cend(),
-        0,
-        std::plus<int> (),
-        [](const auto& a) { return a->getColumnWidth(); }
-        );
-        leftPadding = (config::CONSOLE_WIDTH - tableWidth) / 2;
-        rightPadding = leftPadding;
+        auto buffer = RenderBuffer(sink, RenderBuffer::DEFAULT_CAPACITY, allocator);
+        renderTo(buffer);
+        buffer.flush();
+        sink.flush();
     }
 
-    Table(const std::vector<AbstractColumn*>& _columns, std::wstring _title, int _consoleWidth, bool selfCentered=true)
-    :
-    columns {_columns},
-    title {_title},
-    tableWidth {0}
+    void dumpTableTo(std::ostream& os) const
     {
-        // Center table
-        tableWidth = std::transform_reduce(
-        columns.cbegin(), columns.cend(),
-        0,
-        std::plus<int> (),
-        [](const auto& a) { return a->getColumnWidth(); }
-        );
+        auto sink = StreamSink(os);
+        dumpTableTo(sink);
+    }
 
-        if (!selfCentered)
-        {
-            consoleWidth = tableWidth;
-        }
-        else
-        {
-            consoleWidth = _consoleWidth;
-        }
-        leftPadding = (consoleWidth - tableWidth) / 2;
-        rightPadding = leftPadding;
+    /// Wide streams get the same text, decoded from UTF-8.
+    void dumpTableTo(std::wostream& os) const
+    {
+        auto sink = WideStreamSink(os);
+        dumpTableTo(sink);
     }
 
-    std::wstring nSpace(int n) const
+    allocator_type get_allocator() const
+    {
+        return allocator;
+    }
+
+private:
+    allocator_type allocator;
+};
+
+/** Columns side by side under a centered title. A table does not own its columns: they
+ *  are created in the RenderArena of the render together with the table, and nested
+ *  tables are columns' cells created in the same arena.
+ */
+class Table : public AbstractTable {
+public:
+    /// Columns given in braces, spelled out when the table is created with RenderArena::create
+    using ColumnList = std::initializer_list<AbstractColumn*>;
+
+    int tableWidth;
+
+    /// Centered on a console of _consoleWidth characters, or as wide as the columns when not selfCentered
+    Table(std::allocator_arg_t, const allocator_type& allocator,
+          std::initializer_list<AbstractColumn*> _columns, std::wstring_view _title,
+          int _consoleWidth = config::CONSOLE_WIDTH, bool selfCentered = true)
+    :
+    AbstractTable(allocator),
+    tableWidth {0},
+    title {_title, allocator},
+    columns {_columns, allocator},
+    columnOffsets {allocator}
     {
-        return std::wstring(n, ' ');
+        layout(_consoleWidth, selfCentered);
     }
 
-    std::wstring doubleLine(int n) const
+    /// Columns from any range of column pointers
+    template <typename ColumnRange>
+    Table(std::allocator_arg_t, const allocator_type& allocator,
+          const ColumnRange& _columns, std::wstring_view _title,
+          int _consoleWidth = config::CONSOLE_WIDTH, bool selfCentered = true)
+    :
+    AbstractTable(allocator),
+    tableWidth {0},
+    title {_title, allocator},
+    columns {std::cbegin(_columns), std::cend(_columns), allocator},
+    columnOffsets {allocator}
     {
-        return std::wstring(n, L'=');
+        layout(_consoleWidth, selfCentered);
     }
 
+    Table(std::initializer_list<AbstractColumn*> _columns, std::wstring_view _title,
+          int _consoleWidth = config::CONSOLE_WIDTH, bool selfCentered = true)
+    :
+    Table(std::allocator_arg, allocator_type(), _columns, _title, _consoleWidth, selfCentered)
+    {}
+
+    template <typename ColumnRange>
+    Table(const ColumnRange& _columns, std::wstring_view _title,
+          int _consoleWidth = config::CONSOLE_WIDTH, bool selfCentered = true)
+    :
+    Table(std::allocator_arg, allocator_type(), _columns, _title, _consoleWidth, selfCentered)
+    {}
+
     std::wstring singleLine(int n)
     {
         return std::wstring(n, '_');
     }
 
-    void dumpTableTo(std::wostream& os) const
+    int getTableWidth() const override
     {
+        return tableWidth;
+    }
+
+    void renderTo(RenderBuffer& buffer) const override
+    {
+        const int baseIndent = buffer.getIndent();
         if (!title.empty())
         {
-            os << nSpace(leftPadding)
-               << title
-               << std::endl;
+            buffer.appendSpaces(leftPadding);
+            buffer.append(title);
+            buffer.newline();
 
-            os << nSpace(leftPadding)
-               << doubleLine(consoleWidth - leftPadding - rightPadding)
-               << std::endl;
+            buffer.appendSpaces(leftPadding);
+            buffer.appendRepeated('=', std::max(tableWidth, consoleWidth - leftPadding - rightPadding));
+            buffer.newline();
         }
 
         for (std::size_t i = 0; i <= columns.at(0)->getSize(); i++)
         {
-            os << nSpace(leftPadding);
-            for (auto columnIt = columns.begin(); columnIt != columns.end(); columnIt++)
+            buffer.appendSpaces(leftPadding);
+            for (std::size_t c = 0; c < columns.size(); c++)
             {
-                auto& column = *columnIt;
-                std::wstringstream tmpOs;
-                column->dumpNext(tmpOs);
-                wchar_t t ;
-                while (tmpOs.get(t))
-                {
-                    if (t != '\n')
-                    {
-                        os << t;
-                    }
-                    else
-                    {
-                        auto previousColumnsWidth =
-                        std::transform_reduce(
-                            columns.begin(), columnIt,
-                            leftPadding,
-                            std::plus<>(),
-                            [](const auto& col){ return col->getColumnWidth();}
-                        );
-                        os << t
-                            << nSpace(previousColumnsWidth);
-                    }
-                }
+                // line breaks inside a cell continue under the start of its column
+                buffer.setIndent(baseIndent + columnOffsets[c]);
+                columns[c]->dumpNext(buffer);
             }
-            os << std::endl;
+            buffer.setIndent(baseIndent);
+            buffer.newline();
         }
 
         for (auto* column : columns)
             column->reset();
     }
 
-    ~Table()
-    {
-        std::destroy(columns.begin(), columns.end());
-        for (AbstractColumn* columnPtr : columns)
-            delete columnPtr;
-    }
-
 private:
     int consoleWidth;
-    std::wstring title;
+    std::pmr::wstring title;
     // Must use polymorphism because Columns
     // might contains items of different types.
-    std::vector<AbstractColumn*> columns;
+    std::pmr::vector<AbstractColumn*> columns;
     int leftPadding, rightPadding;
+    // Distance from the left edge of the console to the start of each column
+    std::pmr::vector<int> columnOffsets;
+
+    void layout(int _consoleWidth, bool selfCentered)
+    {
+        // Center table
+        tableWidth = std::transform_reduce(
+        columns.cbegin(), columns.cend(),
+        0,
+        std::plus<int> (),
+        [](const auto& a) { return a->getColumnWidth(); }
+        );
+
+        // Tables wider than the console are not centered
+        consoleWidth = selfCentered ? _consoleWidth : tableWidth;
+        leftPadding = std::max(0, (consoleWidth - tableWidth) / 2);
+        rightPadding = leftPadding;
+        computeColumnOffsets();
+    }
+
+    void computeColumnOffsets()
+    {
+        columnOffsets.clear();
+        int offset = leftPadding;
+        for (const auto* column : columns)
+        {
+            columnOffsets.push_back(offset);
+            offset += column->getColumnWidth();
+        }
+    }
 };
 
 #endif //PROJ1_TABLE_H
@@ -0,0 +1,264 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_TYPEDTABLE_H
+#define PROJ1_TYPEDTABLE_H
+
+#include <array>
+#include <tuple>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <utility>
+#include <memory_resource>
+#include <type_traits>
+#include <algorithm>
+#include "Table.h"
+#include "Column.h"
+#include "RenderBuffer.h"
+#include "NumberFormat.h"
+#include "StreamingColumn.h"
+#include "configuration.h"
+
+/** One column of a TypedTable: the type of its cells, its title and its padding.
+ *  The title is not copied, it must outlive the table (column titles are literals).
+ */
+template <typename T>
+struct Col
+{
+    using value_type = T;
+
+    std::wstring_view title;
+    int leftPadding = 0;
+    int rightPadding = 5;
+};
+
+namespace typed_table_detail
+{
+    template <typename T>
+    struct IsOptional : std::false_type {};
+
+    template <typename T>
+    struct IsOptional<std::optional<T>> : std::true_type {};
+
+    /** Call show with the text of a cell: a FormattedNumber, UTF-8 text or wide text,
+     *  all of which have size() as their display width. Numbers are shown as Column shows
+     *  them and optional numbers as MixedColumn shows them, so tables look the same.
+     */
+    template <typename T, typename Show>
+    std::size_t showCell(const T& value, Show show)
+    {
+        if constexpr (IsOptional<T>::value)
+        {
+            static_assert(std::is_arithmetic<typename T::value_type>::value, "Only optional numbers can be shown");
+            if (!value.has_value())
+                return show(std::string_view("None"));
+            return show(FormattedNumber::streamed(value.value()));
+        }
+        else if constexpr (std::is_arithmetic<T>::value)
+            return show(formatColumnNumber(value));
+        else if constexpr (std::is_convertible<const T&, std::string_view>::value)
+            return show(std::string_view(value));
+        else
+            return show(std::wstring_view(value));
+    }
+
+    template <typename T>
+    std::size_t cellWidth(const T& value)
+    {
+        return showCell(value, [](const auto& text) { return text.size(); });
+    }
+}
+
+/** Table whose columns are fixed at compile time, such as
+ *  TypedTable<Col<std::wstring>, Col<double>, Col<long>>. A row is a tuple of the column
+ *  types and is rendered by a fold over the columns, so every cell is formatted and
+ *  appended without a virtual call. The output has the same layout as a Table.
+ *
+ *  Rows are either added with addRow or read from a RowStream, which is replayed once
+ *  to measure the columns and once to render them, so nothing is stored per row.
+ */
+template <typename ...Cols>
+class TypedTable : public AbstractTable
+{
+public:
+    static_assert(sizeof...(Cols) > 0, "A table needs at least one column");
+
+    using Row = std::tuple<typename Cols::value_type...>;
+    using Columns = std::tuple<Cols...>;
+
+    /// Rows are added with addRow. Centered on a console of _consoleWidth characters, or as wide as the columns when not selfCentered
+    TypedTable(std::allocator_arg_t, const allocator_type& allocator,
+               const Columns& _columns, std::wstring_view _title,
+               int _consoleWidth = config::CONSOLE_WIDTH, bool selfCentered = true)
+    :
+    AbstractTable(allocator),
+    columns {_columns},
+    title {_title, allocator},
+    rows {allocator},
+    stream {nullptr},
+    consoleWidth {_consoleWidth},
+    selfCentered {selfCentered}
+    {
+        measureTitles(Indices());
+    }
+
+    /// Rows of a stream that must outlive the table
+    TypedTable(std::allocator_arg_t, const allocator_type& allocator,
+               RowStream<Row>& _stream, const Columns& _columns, std::wstring_view _title,
+               int _consoleWidth = config::CONSOLE_WIDTH, bool selfCentered = true)
+    :
+    TypedTable(std::allocator_arg, allocator, _columns, _title, _consoleWidth, selfCentered)
+    {
+        stream = &_stream;
+        auto row = Row();
+        stream->rewind();
+        while (stream->next(row))
+            measureRow(row, Indices());
+        stream->rewind();
+    }
+
+    TypedTable(const Columns& _columns, std::wstring_view _title,
+               int _consoleWidth = config::CONSOLE_WIDTH, bool selfCentered = true)
+    :
+    TypedTable(std::allocator_arg, allocator_type(), _columns, _title, _consoleWidth, selfCentered)
+    {}
+
+    TypedTable(RowStream<Row>& _stream, const Columns& _columns, std::wstring_view _title,
+               int _consoleWidth = config::CONSOLE_WIDTH, bool selfCentered = true)
+    :
+    TypedTable(std::allocator_arg, allocator_type(), _stream, _columns, _title, _consoleWidth, selfCentered)
+    {}
+
+    void addRow(const typename Cols::value_type&... values)
+    {
+        rows.emplace_back(values...);
+        measureRow(rows.back(), Indices());
+    }
+
+    int getTableWidth() const override
+    {
+        int tableWidth = 0;
+        for (std::size_t c = 0; c < sizeof...(Cols); c++)
+            tableWidth += columnWidths[c];
+        return tableWidth;
+    }
+
+    void renderTo(RenderBuffer& buffer) const override
+    {
+        const int tableWidth = getTableWidth();
+        const int width = selfCentered ? consoleWidth : tableWidth;
+        // Tables wider than the console are not centered
+        const int padding = std::max(0, (width - tableWidth) / 2);
+
+        if (!title.empty())
+        {
+            buffer.appendSpaces(padding);
+            buffer.append(title);
+            buffer.newline();
+
+            buffer.appendSpaces(padding);
+            buffer.appendRepeated('=', std::max(tableWidth, width - 2 * padding));
+            buffer.newline();
+        }
+
+        if (hasColumnTitles)
+        {
+            buffer.appendSpaces(padding);
+            renderColumnTitles(buffer, Indices());
+            buffer.newline();
+        }
+
+        if (stream != nullptr)
+        {
+            auto row = Row();
+            stream->rewind();
+            while (stream->next(row))
+                renderRow(buffer, padding, row);
+            stream->rewind();
+        }
+        else
+        {
+            for (const auto& row : rows)
+                renderRow(buffer, padding, row);
+        }
+
+        // a Table gives its columns one more line than they have rows, their titles or an empty one
+        if (!hasColumnTitles)
+        {
+            buffer.appendSpaces(padding);
+            buffer.newline();
+        }
+    }
+
+private:
+    using Indices = std::index_sequence_for<Cols...>;
+
+    Columns columns;
+    std::pmr::wstring title;
+    std::pmr::vector<Row> rows;
+    RowStream<Row>* stream;
+    int consoleWidth;
+    bool selfCentered;
+    bool hasColumnTitles = false;
+    // Widest cell or title of each column
+    std::array<std::size_t, sizeof...(Cols)> maxCharLengths {};
+    // Padding included
+    std::array<int, sizeof...(Cols)> columnWidths {};
+
+    template <std::size_t ...I>
+    void measureTitles(std::index_sequence<I...>)
+    {
+        hasColumnTitles = (!std::get<I>(columns).title.empty() || ...);
+        (measure<I>(std::get<I>(columns).title.size()), ...);
+    }
+
+    template <std::size_t ...I>
+    void measureRow(const Row& row, std::index_sequence<I...>)
+    {
+        (measure<I>(typed_table_detail::cellWidth(std::get<I>(row))), ...);
+    }
+
+    template <std::size_t I>
+    void measure(std::size_t charLength)
+    {
+        maxCharLengths[I] = std::max(maxCharLengths[I], charLength);
+        const auto& column = std::get<I>(columns);
+        columnWidths[I] = column.leftPadding + static_cast<int>(maxCharLengths[I]) + column.rightPadding;
+    }
+
+    template <std::size_t ...I>
+    void renderColumnTitles(RenderBuffer& buffer, std::index_sequence<I...>) const
+    {
+        (renderCell<I>(buffer, std::get<I>(columns).title), ...);
+    }
+
+    void renderRow(RenderBuffer& buffer, int padding, const Row& row) const
+    {
+        buffer.appendSpaces(padding);
+        renderCells(buffer, row, Indices());
+        buffer.newline();
+    }
+
+    template <std::size_t ...I>
+    void renderCells(RenderBuffer& buffer, const Row& row, std::index_sequence<I...>) const
+    {
+        (renderCell<I>(buffer, std::get<I>(row)), ...);
+    }
+
+    template <std::size_t I, typename T>
+    void renderCell(RenderBuffer& buffer, const T& value) const
+    {
+        const auto& column = std::get<I>(columns);
+        buffer.appendSpaces(column.leftPadding);
+        auto charLength = typed_table_detail::showCell(value, [&buffer](const auto& text)
+        {
+            buffer.append(text);
+            return text.size();
+        });
+        buffer.appendSpaces(static_cast<long>(maxCharLengths[I]) - static_cast<long>(charLength) + column.rightPadding);
+    }
+};
+
+#endif //PROJ1_TYPEDTABLE_H
@@ -0,0 +1,103 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_UTF8_H
+#define PROJ1_UTF8_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <iterator>
+
+/// Append the UTF-8 encoding of a code point. Invalid code points become U+FFFD.
+template <typename OutputIt>
+OutputIt encodeUtf8(char32_t codePoint, OutputIt out)
+{
+    if (codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+        codePoint = 0xFFFD;
+    if (codePoint < 0x80)
+        *out++ = static_cast<char>(codePoint);
+    else if (codePoint < 0x800)
+    {
+        *out++ = static_cast<char>(0xC0 | (codePoint >> 6));
+        *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000)
+    {
+        *out++ = static_cast<char>(0xE0 | (codePoint >> 12));
+        *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else
+    {
+        *out++ = static_cast<char>(0xF0 | (codePoint >> 18));
+        *out++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    return out;
+}
+
+/// UTF-8 text of a wide string, one code point per wchar_t.
+inline std::string toUtf8(std::wstring_view wide)
+{
+    std::string text;
+    text.reserve(wide.size());
+    for (wchar_t c : wide)
+        encodeUtf8(static_cast<char32_t>(c), std::back_inserter(text));
+    return text;
+}
+
+/** Incremental UTF-8 decoder. A sequence cut between two calls to decode is
+ *  completed by the next call. Malformed input decodes to U+FFFD.
+ */
+class Utf8Decoder
+{
+public:
+    /// Decode text and pass every code point to emit.
+    template <typename Emit>
+    void decode(std::string_view text, Emit emit)
+    {
+        for (char c : text)
+        {
+            auto byte = static_cast<unsigned char>(c);
+            if (pendingBytes > 0 && (byte & 0xC0) == 0x80)
+            {
+                codePoint = (codePoint << 6) | (byte & 0x3F);
+                if (--pendingBytes == 0)
+                    emit(codePoint);
+                continue;
+            }
+            if (pendingBytes > 0)
+            {
+                // sequence cut short by a byte that does not continue it
+                pendingBytes = 0;
+                emit(REPLACEMENT);
+            }
+            if (byte < 0x80)
+                emit(static_cast<char32_t>(byte));
+            else if ((byte & 0xE0) == 0xC0)
+                start(byte & 0x1F, 1);
+            else if ((byte & 0xF0) == 0xE0)
+                start(byte & 0x0F, 2);
+            else if ((byte & 0xF8) == 0xF0)
+                start(byte & 0x07, 3);
+            else
+                emit(REPLACEMENT);
+        }
+    }
+
+private:
+    static constexpr char32_t REPLACEMENT = 0xFFFD;
+    char32_t codePoint = 0;
+    int pendingBytes = 0;
+
+    void start(char32_t leadingBits, int continuationBytes)
+    {
+        codePoint = leadingBits;
+        pendingBytes = continuationBytes;
+    }
+};
+
+#endif //PROJ1_UTF8_H
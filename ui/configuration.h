@@ -9,6 +9,20 @@ namespace config {
     const int CONSOLE_WIDTH = 120;
     const int FLOAT_NUMBER_DIGITS = 2;
     const int ARRAY_MAX_WRAPPING_LENGTH = 10;
+    const int ROLLING_COLUMN_WIDTH = 14;
+    const double SAMPLE_CONFIDENCE_LEVEL = 0.95;
+    const int SAMPLE_BOOTSTRAP_RESAMPLES = 200;
+    const unsigned long SAMPLE_SEED = 2021;
+    const int PREVIEW_SLICE_LENGTH = 10;
+    const int PREVIEW_SAMPLE_SIZE = 10;
+    const int PREVIEW_SPARKLINE_WIDTH = 40;
+    // values of the files analyzed together by --summarize
+    const unsigned long BATCH_MEMORY_LIMIT_MB = 1024;
+    // summaries of streams that are read once, by --watch
+    const unsigned long SKETCH_K = 200;
+    const unsigned long HEAVY_HITTERS_CAPACITY = 1024;
+    const int WATCH_TOP_VALUES = 10;
+    const int WATCH_INTERVAL_MS = 1000;
 }
 
 #endif //PROJ1_CONFIGURATION_H
@@ -0,0 +1,151 @@
+//
+// Created by dop on 10/19/26.
+//
+
+#ifndef PROJ1_WORKSTEALINGPOOL_H
+#define PROJ1_WORKSTEALINGPOOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+
+/** Fixed set of worker threads, each with its own queue of tasks. Tasks are dealt to the
+ *  queues in turn; a worker runs the newest task of its own queue and, once that is empty,
+ *  steals the oldest task of another queue, so a worker stuck on a long task does not hold
+ *  up the tasks queued behind it.
+ *
+ *  Tasks must not throw.
+ */
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(std::size_t threadCount = std::thread::hardware_concurrency())
+    {
+        threadCount = std::max<std::size_t>(1, threadCount);
+        for (std::size_t i = 0; i < threadCount; i++)
+            queues.push_back(std::make_unique<TaskQueue>());
+        for (std::size_t i = 0; i < threadCount; i++)
+            workers.emplace_back(&WorkStealingPool::run, this, i);
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /// Runs the tasks that were submitted, then stops the workers
+    ~WorkStealingPool()
+    {
+        wait();
+        {
+            auto lock = std::lock_guard<std::mutex>(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    std::size_t getThreadCount() const
+    {
+        return workers.size();
+    }
+
+    void submit(Task task)
+    {
+        auto& queue = *queues[nextQueue++ % queues.size()];
+        // counted first, a worker that takes the task at once must not count it down below zero
+        {
+            auto lock = std::lock_guard<std::mutex>(mutex);
+            queuedCount++;
+            unfinishedCount++;
+        }
+        {
+            auto lock = std::lock_guard<std::mutex>(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        wake.notify_one();
+    }
+
+    /// Block until every submitted task has run
+    void wait()
+    {
+        auto lock = std::unique_lock<std::mutex>(mutex);
+        finished.wait(lock, [this] { return unfinishedCount == 0; });
+    }
+
+private:
+    struct TaskQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> workers;
+    std::size_t nextQueue = 0;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    // tasks in the queues, and tasks that have not finished running
+    std::atomic<std::size_t> queuedCount {0};
+    std::size_t unfinishedCount = 0;
+    bool stopping = false;
+
+    void run(std::size_t index)
+    {
+        while (true)
+        {
+            Task task;
+            if (popOwn(index, task) || steal(index, task))
+            {
+                queuedCount--;
+                task();
+                auto lock = std::lock_guard<std::mutex>(mutex);
+                if (--unfinishedCount == 0)
+                    finished.notify_all();
+                continue;
+            }
+
+            auto lock = std::unique_lock<std::mutex>(mutex);
+            wake.wait(lock, [this] { return stopping || queuedCount > 0; });
+            if (stopping && queuedCount == 0)
+                return;
+        }
+    }
+
+    bool popOwn(std::size_t index, Task& task)
+    {
+        auto& queue = *queues[index];
+        auto lock = std::lock_guard<std::mutex>(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(std::size_t index, Task& task)
+    {
+        for (std::size_t offset = 1; offset < queues.size(); offset++)
+        {
+            auto& queue = *queues[(index + offset) % queues.size()];
+            auto lock = std::lock_guard<std::mutex>(queue.mutex);
+            if (queue.tasks.empty())
+                continue;
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+};
+
+#endif //PROJ1_WORKSTEALINGPOOL_H